@@ -0,0 +1,108 @@
+#ifndef ARCTICVOX_HASH_HPP
+#define ARCTICVOX_HASH_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace arcticvox {
+
+namespace detail {
+inline constexpr uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ULL;
+inline constexpr uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+inline constexpr uint64_t HASH_PRIME_3 = 0x165667B19E3779F9ULL;
+inline constexpr uint64_t HASH_PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+inline constexpr uint64_t HASH_PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t hash_round(uint64_t acc, const uint64_t input) {
+    acc += input * HASH_PRIME_2;
+    acc = std::rotl(acc, 31);
+    return acc * HASH_PRIME_1;
+}
+
+inline uint64_t hash_merge(uint64_t acc, const uint64_t lane) {
+    acc ^= hash_round(0U, lane);
+    return acc * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+inline uint64_t hash_read_u64(const std::byte* ptr) {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+}
+
+/**
+ * @brief Computes a non-cryptographic 64 bit hash of a block of memory
+ *
+ * @param data Pointer to the first byte to hash
+ * @param size The number of bytes to hash
+ * @param seed Seed of the hash
+ * @return The 64 bit hash value
+ *
+ * @details The hash follows the structure of XXH64: four independent lanes consume 32 byte
+ * stripes, so large inputs (e.g. whole model files) are hashed at close to memory bandwidth. The
+ * result is only stable on little endian machines, which is all we target.
+ */
+inline uint64_t hash_bytes(const void* data, const std::size_t size, const uint64_t seed = 0U) {
+    using namespace detail;
+    const std::byte* ptr = static_cast<const std::byte*>(data);
+    const std::byte* const end = ptr + size;
+    uint64_t hash;
+
+    if(size >= 32U) {
+        uint64_t lane_1 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+        uint64_t lane_2 = seed + HASH_PRIME_2;
+        uint64_t lane_3 = seed;
+        uint64_t lane_4 = seed - HASH_PRIME_1;
+
+        // lengths are compared rather than pointers, which must not move past the end
+        do {
+            lane_1 = hash_round(lane_1, hash_read_u64(ptr));
+            lane_2 = hash_round(lane_2, hash_read_u64(ptr + 8U));
+            lane_3 = hash_round(lane_3, hash_read_u64(ptr + 16U));
+            lane_4 = hash_round(lane_4, hash_read_u64(ptr + 24U));
+            ptr += 32U;
+        } while(end - ptr >= 32);
+
+        hash = std::rotl(lane_1, 1) + std::rotl(lane_2, 7) + std::rotl(lane_3, 12)
+               + std::rotl(lane_4, 18);
+        hash = hash_merge(hash, lane_1);
+        hash = hash_merge(hash, lane_2);
+        hash = hash_merge(hash, lane_3);
+        hash = hash_merge(hash, lane_4);
+    } else {
+        hash = seed + HASH_PRIME_5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    for(; end - ptr >= 8; ptr += 8U) {
+        hash ^= hash_round(0U, hash_read_u64(ptr));
+        hash = std::rotl(hash, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+    }
+    if(end - ptr >= 4) {
+        uint32_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        hash ^= static_cast<uint64_t>(value) * HASH_PRIME_1;
+        hash = std::rotl(hash, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+        ptr += 4U;
+    }
+    for(; ptr < end; ++ptr) {
+        hash ^= static_cast<uint64_t>(*ptr) * HASH_PRIME_5;
+        hash = std::rotl(hash, 11) * HASH_PRIME_1;
+    }
+
+    // final avalanche
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}
+
+#endif
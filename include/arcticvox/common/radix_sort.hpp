@@ -0,0 +1,33 @@
+#ifndef ARCTICVOX_RADIX_SORT_HPP
+#define ARCTICVOX_RADIX_SORT_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace arcticvox {
+
+/**
+ * @class radix_sorter
+ * @brief Sorts 64 bit keys together with a 32 bit value each, reusing its buffers between sorts
+ *
+ * @details A stable least significant digit radix sort over bytes. Passes over bytes that are the
+ * same in all keys are skipped, so keys that only differ in few bits sort in few passes.
+ */
+class radix_sorter final {
+  public:
+    /**
+     * @brief Sorts the keys ascending and moves the values along with them
+     *
+     * @param keys The keys to sort
+     * @param values The values, one per key
+     */
+    void sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values);
+
+  private:
+    std::vector<uint64_t> key_scratch_ {};
+    std::vector<uint32_t> value_scratch_ {};
+};
+
+}
+
+#endif
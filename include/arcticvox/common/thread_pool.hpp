@@ -0,0 +1,127 @@
+#ifndef ARCTICVOX_THREAD_POOL_HPP
+#define ARCTICVOX_THREAD_POOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace arcticvox {
+
+/**
+ * @class thread_pool
+ * @brief Fixed set of worker threads processing a shared FIFO queue of tasks
+ *
+ * @details Threads waiting on results of the pool (parallel_for() and wait()) execute queued
+ * tasks while waiting, so it is safe to use the pool from within one of its own tasks.
+ */
+class thread_pool final {
+  public:
+    /**
+     * @brief Starts the worker threads
+     *
+     * @param thread_count The number of workers, 0 uses one worker per hardware thread
+     */
+    explicit thread_pool(std::size_t thread_count = 0U);
+
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool(thread_pool&& other) = delete;
+
+    /**
+     * @brief Finishes all queued tasks and joins the worker threads
+     */
+    ~thread_pool();
+
+    thread_pool& operator=(const thread_pool& other) = delete;
+    thread_pool& operator=(thread_pool&& other) = delete;
+
+    /**
+     * @brief Queues a task for execution on one of the workers
+     *
+     * @param task The callable to execute
+     * @return A future holding the result of the task or the exception it threw
+     */
+    template<typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using result_type = std::invoke_result_t<std::decay_t<F>>;
+        // std::function requires copyable callables, so the packaged task is shared
+        auto packaged =
+            std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+        std::future<result_type> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    /**
+     * @brief Calls fn for every index in [0, count) using the workers and the calling thread
+     *
+     * @param count The number of indices
+     * @param fn The function to call for every index
+     *
+     * @details Blocks until all indices have been processed. The first exception thrown by fn is
+     * rethrown on the calling thread after all workers have finished.
+     */
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& fn);
+
+    /**
+     * @brief Blocks until the future is ready, executing queued tasks in the meantime
+     *
+     * @param future The future of a task submitted to this pool
+     */
+    template<typename T>
+    void wait(const std::future<T>& future) {
+        const auto ready = [&future]() {
+            return future.wait_for(std::chrono::seconds {0}) == std::future_status::ready;
+        };
+        while(!ready()) {
+            if(run_pending_task())
+                continue;
+            // woken once a task finished, which might have been the awaited one, or was queued
+            std::unique_lock lock {mutex_};
+            task_changed_.wait(lock, [&]() { return ready() || !tasks_.empty(); });
+        }
+    }
+
+    /**
+     * @brief Returns the number of worker threads
+     */
+    [[nodiscard]] std::size_t size() const {
+        return workers_.size();
+    }
+
+  private:
+    void enqueue(std::function<void()> task);
+
+    /**
+     * @brief Pops and executes one queued task on the calling thread
+     *
+     * @return False if the queue was empty
+     */
+    bool run_pending_task();
+
+    /**
+     * @brief Wakes the threads in wait() after a task has finished
+     */
+    void finish_task();
+
+    void worker_loop();
+
+    std::mutex mutex_;                           //!< Guards tasks_ and stopping_
+    std::condition_variable task_available_;     //!< Signalled when a task is queued
+    std::condition_variable task_changed_;       //!< Signalled when a task is queued or finished
+    std::deque<std::function<void()>> tasks_;    //!< Tasks waiting for execution
+    bool stopping_ = false;                      //!< Set on destruction to end the workers
+
+    std::vector<std::thread> workers_;           //!< The worker threads
+};
+
+}
+
+#endif
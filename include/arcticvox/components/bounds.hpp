@@ -0,0 +1,63 @@
+#ifndef ARCTICVOX_BOUNDS_HPP
+#define ARCTICVOX_BOUNDS_HPP
+
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace arcticvox::components {
+
+/**
+ * @brief Axis aligned bounding box
+ *
+ * @details A default constructed box is empty (min > max), so that extending it with the first
+ * point yields a box containing exactly that point.
+ */
+struct aabb {
+    glm::vec3 min {std::numeric_limits<float>::max()};
+    glm::vec3 max {std::numeric_limits<float>::lowest()};
+
+    void extend(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void extend(const aabb& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return (min.x > max.x) || (min.y > max.y) || (min.z > max.z);
+    }
+
+    [[nodiscard]] glm::vec3 center() const {
+        return (min + max) * 0.5f;
+    }
+
+    [[nodiscard]] glm::vec3 extent() const {
+        return max - min;
+    }
+
+    /**
+     * @brief Returns the axis aligned box enclosing this box after an affine transformation
+     */
+    [[nodiscard]] aabb transformed(const glm::mat4& matrix) const {
+        if(empty())
+            return aabb {};
+
+        const glm::vec3 half_extent = extent() * 0.5f;
+        const glm::vec3 new_center {matrix * glm::vec4 {center(), 1.0f}};
+        glm::vec3 new_half_extent {0.0f};
+        for(int axis = 0; axis < 3; ++axis)
+            new_half_extent += glm::abs(glm::vec3 {matrix[axis]}) * half_extent[axis];
+        return aabb {.min = new_center - new_half_extent, .max = new_center + new_half_extent};
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef ARCTICVOX_CAMERA_UNIFORM_HPP
+#define ARCTICVOX_CAMERA_UNIFORM_HPP
+
+#include <glm/matrix.hpp>
+
+namespace arcticvox::components {
+//! Shared by all draws of a frame and bound once per frame, the model matrices come from
+//! components::instance. Matches the shaders' std140 layout.
+struct camera_uniform_data {
+    glm::mat4 view {1.0f};               //!< World space to view space
+    glm::mat4 projection {1.0f};         //!< View space to clip space
+    glm::mat4 projection_view {1.0f};    //!< World space to clip space
+};
+}
+
+#endif
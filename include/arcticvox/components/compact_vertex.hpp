@@ -0,0 +1,54 @@
+#ifndef ARCTICVOX_COMPACT_VERTEX_HPP
+#define ARCTICVOX_COMPACT_VERTEX_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <glm/matrix.hpp>
+
+#include "arcticvox/components/bounds.hpp"
+#include "arcticvox/components/vertex.hpp"
+
+namespace arcticvox::components {
+
+/**
+ * @class compact_vertex
+ * @brief Quantised 20 byte vertex layout
+ *
+ * @details Positions are stored as 16 bit unsigned normalised values relative to the bounds of the
+ * model, so the vertex shader only has to apply the dequantisation matrix to get back to model
+ * space. Normals are octahedral encoded into two 16 bit signed normalised values, texture
+ * coordinates are half floats and the colour is stored with 8 bits per channel.
+ */
+class compact_vertex {
+  public:
+    static std::vector<vk::VertexInputBindingDescription> get_binding_description();
+    static std::vector<vk::VertexInputAttributeDescription> get_attribute_description();
+
+    /**
+     * @brief Quantises a vertex
+     *
+     * @param vtx The vertex to quantise
+     * @param bounds The bounds the position is quantised relative to, has to contain the position
+     * @return The quantised vertex
+     */
+    [[nodiscard]] static compact_vertex quantise(const vertex& vtx, const aabb& bounds);
+
+    /**
+     * @brief Returns the matrix mapping quantised positions back into the bounds
+     */
+    [[nodiscard]] static glm::mat4 dequantisation_matrix(const aabb& bounds);
+
+    std::array<uint16_t, 4U> position;    //!< Unorm position within the bounds, w is unused
+    std::array<uint8_t, 4U> colour;       //!< Unorm RGBA colour
+    std::array<int16_t, 2U> normal;       //!< Snorm octahedral encoded normal
+    std::array<uint16_t, 2U> uv;          //!< Half float texture coordinates
+};
+static_assert(sizeof(compact_vertex) == 20U);
+
+}
+
+#endif
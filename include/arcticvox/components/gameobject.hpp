@@ -6,14 +6,20 @@
 #include <glm/vec3.hpp>
 
 #include "arcticvox/components/model.hpp"
+#include "arcticvox/components/model_handle.hpp"
 #include "arcticvox/components/transform.hpp"
+#include "arcticvox/components/transform_store.hpp"
 
 namespace arcticvox::components {
 class gameobject {
   public:
-    static gameobject make_gameobject() {
+    /**
+     * @brief Creates a gameobject whose transform lives in the store
+     */
+    static gameobject make_gameobject(transform_store& transforms,
+                                      const components::transform& initial = {}) {
         static std::size_t current_id = 0;
-        return gameobject(current_id++);
+        return gameobject(current_id++, transforms.create(initial));
     }
 
     gameobject(const gameobject& other) = delete;
@@ -27,11 +33,16 @@ class gameobject {
     }
 
     std::shared_ptr<model> model {};
+    //! model streamed in the background, replaces model at the next frame once it is resident
+    model_handle pending_model {};
     glm::vec3 colour {};
-    transform transform {};
+    //! set through the transform store, which caches its world matrix
+    transform_store::handle transform;
 
   private:
-    gameobject(const std::size_t id) : id_(id) { }
+    gameobject(const std::size_t id, const transform_store::handle transform_id) :
+        transform(transform_id),
+        id_(id) { }
 
     std::size_t id_;
 };
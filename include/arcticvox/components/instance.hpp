@@ -0,0 +1,39 @@
+#ifndef ARCTICVOX_INSTANCE_HPP
+#define ARCTICVOX_INSTANCE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+
+namespace arcticvox::components {
+
+/**
+ * @class instance
+ * @brief Per instance vertex attributes of a gameobject, read from the second vertex binding
+ *
+ * @details Gameobjects sharing a model are drawn with a single instanced draw per submesh, every
+ * instance brings its own model matrix and colour. Draws address their instances through their
+ * first instance, which also works for draws read from an indirect buffer. The attributes follow
+ * the vertex attributes of both vertex formats, starting at FIRST_LOCATION.
+ */
+class instance {
+  public:
+    static constexpr uint32_t BINDING = 1U;
+    static constexpr uint32_t FIRST_LOCATION = 4U;
+
+    static std::vector<vk::VertexInputBindingDescription> get_binding_description();
+    static std::vector<vk::VertexInputAttributeDescription> get_attribute_description();
+
+    //! Transforms the vertices into world space, including the submesh node transform and the
+    //! vertex dequantisation, one location per column
+    glm::mat4 model_matrix;
+    glm::vec4 colour;
+};
+
+}
+
+#endif
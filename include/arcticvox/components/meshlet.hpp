@@ -0,0 +1,34 @@
+#ifndef ARCTICVOX_MESHLET_HPP
+#define ARCTICVOX_MESHLET_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/vec3.hpp>
+
+namespace arcticvox::components {
+
+/**
+ * @brief Small cluster of neighbouring triangles that is culled as a whole
+ *
+ * @details The triangles of a meshlet are contiguous in the model's index buffer, so every visible
+ * meshlet, or run of neighbouring visible meshlets, is a single indexed draw. Bounds and cone are
+ * in the space of the mesh's vertices, i.e. before the submesh transform.
+ */
+struct meshlet {
+    static constexpr uint32_t MAX_VERTICES = 64U;      //!< Unique vertices per meshlet
+    static constexpr uint32_t MAX_TRIANGLES = 124U;    //!< Triangles per meshlet
+
+    uint32_t first_index = 0U;                 //!< First index in the index buffer
+    uint32_t index_count = 0U;                 //!< Number of indices of the meshlet
+    glm::vec3 center {0.0f};                   //!< Center of the bounding sphere
+    float radius = 0.0f;                       //!< Radius of the bounding sphere
+    glm::vec3 cone_axis {0.0f, 0.0f, 1.0f};    //!< Average triangle normal
+    //! Sine of the normal cone's half angle, 1 if the triangles face too many ways to be culled
+    float cone_cutoff = 1.0f;
+};
+static_assert(std::is_trivially_copyable_v<meshlet>);
+
+}
+
+#endif
@@ -1,19 +1,41 @@
 #ifndef ARCTICVOX_MODEL_HPP
 #define ARCTICVOX_MODEL_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 
 #include <vulkan/vulkan_raii.hpp>
 
+#include <glm/matrix.hpp>
+
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/submesh.hpp"
 #include "arcticvox/components/vertex.hpp"
 #include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/geometry_arena.hpp"
 #include "arcticvox/io/model_builder.hpp"
 
 namespace arcticvox::components {
 
+/**
+ * @class model
+ * @brief Draw ranges of a model whose geometry lives in the geometry arena
+ *
+ * @details The geometry can be evicted from the arena and restored from a fresh import of the same
+ * file, the host side data stays. The model may only be drawn while it is resident.
+ */
 class model final {
   public:
+    /**
+     * @brief Whether the model's geometry is in the arena
+     */
+    enum class residency : uint8_t {
+        resident,    //!< Uploaded, the model can be drawn
+        evicted,     //!< Not in the arena
+        restoring    //!< Being imported and uploaded again
+    };
+
     model(graphics::gpu_driver& driver, const io::model_builder& builder);
 
     model(const model& other) = delete;
@@ -22,26 +44,195 @@ class model final {
 
     ~model() = default;
 
-    void draw(vk::raii::CommandBuffer& command_buffer);
-    void bind(vk::raii::CommandBuffer& command_buffer);
+    /**
+     * @brief Draws a single submesh, the geometry arena's buffers have to be bound
+     *
+     * @param command_buffer The command buffer to record into
+     * @param submesh_index The index into submeshes()
+     * @param level The level of detail to draw, 0 is the full mesh
+     * @param instance_count The number of instances to draw
+     * @param first_instance The first instance in the bound instance buffer
+     */
+    void draw(vk::raii::CommandBuffer& command_buffer,
+              std::size_t submesh_index,
+              std::size_t level = 0U,
+              uint32_t instance_count = 1U,
+              uint32_t first_instance = 0U);
+
+    /**
+     * @brief Draws consecutive meshlets of a submesh's full mesh, with the arena bound
+     *
+     * @param command_buffer The command buffer to record into
+     * @param submesh_index The index into submeshes()
+     * @param first_meshlet The first meshlet of the run, relative to the submesh's first_meshlet
+     * @param meshlet_count The number of meshlets in the run
+     * @param first_instance The single instance to draw, in the bound instance buffer
+     *
+     * @details The meshlets of a submesh are contiguous in the index buffer, so the run is a single
+     * indexed draw.
+     */
+    void draw_meshlets(vk::raii::CommandBuffer& command_buffer,
+                       std::size_t submesh_index,
+                       std::size_t first_meshlet,
+                       std::size_t meshlet_count,
+                       uint32_t first_instance = 0U);
+
+    /**
+     * @brief Returns the parameters of draw() as an indirect command
+     *
+     * @details For a model without indices, indexCount holds the vertex count and vertexOffset the
+     * first vertex, to pass to a non indexed draw.
+     */
+    [[nodiscard]] vk::DrawIndexedIndirectCommand draw_command(std::size_t submesh_index,
+                                                              std::size_t level = 0U,
+                                                              uint32_t instance_count = 1U,
+                                                              uint32_t first_instance = 0U) const;
+
+    /**
+     * @brief Returns the parameters of draw_meshlets() as an indirect command
+     *
+     * @details The command draws nothing if the run is empty or out of range.
+     */
+    [[nodiscard]] vk::DrawIndexedIndirectCommand meshlet_draw_command(
+        std::size_t submesh_index,
+        std::size_t first_meshlet,
+        std::size_t meshlet_count,
+        uint32_t first_instance = 0U) const;
+
+    [[nodiscard]] residency get_residency() const {
+        return residency_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool resident() const {
+        return get_residency() == residency::resident;
+    }
+
+    /**
+     * @brief Records that the model was drawn, called by the render thread
+     */
+    void mark_drawn() {
+        drawn_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns whether the model was drawn since the last call, resetting the flag
+     */
+    [[nodiscard]] bool take_drawn() {
+        return drawn_.exchange(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Records that an evicted model was about to be drawn, called by the render thread
+     */
+    void request_residency() {
+        residency_requested_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns whether residency was requested since the last call, resetting the flag
+     */
+    [[nodiscard]] bool take_residency_request() {
+        return residency_requested_.exchange(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the model's geometry to the arena
+     *
+     * @details Called by the render thread, which has to make sure that no frame in flight draws
+     * the model anymore. Does nothing unless the model is resident.
+     */
+    void evict();
+
+    /**
+     * @brief Marks an evicted model as restoring
+     *
+     * @return False if the model was not evicted
+     */
+    [[nodiscard]] bool begin_restore();
+
+    /**
+     * @brief Marks a restoring model as evicted again, if its file could not be reimported
+     */
+    void cancel_restore() {
+        residency_.store(residency::evicted, std::memory_order_release);
+    }
+
+    /**
+     * @brief Uploads the geometry of a restoring model again, it is resident afterwards
+     *
+     * @param builder A fresh import of the model's file with the original settings
+     *
+     * @details Throws std::runtime_error if the import does not match the model or the arena has
+     * no room, the model is evicted again in that case.
+     */
+    void restore(const io::model_builder& builder);
+
+    /**
+     * @brief Returns the type of the model's indices, to bind the arena's index buffer with
+     */
+    [[nodiscard]] vk::IndexType index_type() const {
+        return index_type_;
+    }
+
+    [[nodiscard]] bool has_indices() const {
+        return has_index_buffer;
+    }
+
+    /**
+     * @brief Returns the draw ranges of the model, all within the same vertex and index buffer
+     *
+     * @details Models built without a submesh table get a single submesh covering all indices.
+     */
+    [[nodiscard]] const std::vector<submesh>& submeshes() const {
+        return submeshes_;
+    }
+
+    /**
+     * @brief Returns the meshlets of all submeshes, each submesh refers to its range
+     */
+    [[nodiscard]] const std::vector<meshlet>& meshlets() const {
+        return meshlets_;
+    }
+
+    /**
+     * @brief Returns the layout of the vertex buffer, which selects the pipeline to draw with
+     */
+    [[nodiscard]] vertex_format format() const {
+        return format_;
+    }
+
+    /**
+     * @brief Returns the matrix mapping the stored vertex positions into model space
+     *
+     * @details Identity for full vertices, the dequantisation matrix for compact ones.
+     */
+    [[nodiscard]] const glm::mat4& vertex_transform() const {
+        return vertex_transform_;
+    }
 
   private:
-    void create_vertex_buffers(const std::vector<vertex>& vertices);
-    void create_index_buffers(const std::vector<uint32_t>& indices);
-
-    void copy_vertex_data_to_memory_map(const std::vector<vertex>& vertices);
-    void copy_index_data_to_memory_map(const std::vector<uint32_t>& indices);
+    /**
+     * @brief Allocates the model's geometry arena ranges and uploads vertices and indices
+     */
+    void upload_geometry(const io::model_builder& builder);
 
     graphics::gpu_driver& driver_;
+    vertex_format format_;
+    glm::mat4 vertex_transform_;
     std::size_t vertex_count_;
-    vk::raii::Buffer vertex_buffer_;
-    vk::raii::DeviceMemory vertex_buffer_memory_;
-
     std::size_t indices_count_;
-    vk::raii::Buffer indices_buffer_;
-    vk::raii::DeviceMemory indices_buffer_memory_;
+    graphics::geometry_allocation geometry_;
+    //! 16 bit indices are used whenever all indices fit, they are relative to their submesh
+    vk::IndexType index_type_ = vk::IndexType::eUint32;
+
+    std::vector<submesh> submeshes_;
+    std::vector<meshlet> meshlets_;    //!< Kept on the host for cluster culling
 
     bool has_index_buffer {};
+
+    std::atomic<residency> residency_ {residency::resident};
+    std::atomic<bool> drawn_ {false};                  //!< Drawn since the last take_drawn()
+    std::atomic<bool> residency_requested_ {false};    //!< Needed since the last request was taken
 };
 
 }
@@ -0,0 +1,77 @@
+#ifndef ARCTICVOX_MODEL_HANDLE_HPP
+#define ARCTICVOX_MODEL_HANDLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "arcticvox/components/model.hpp"
+
+namespace arcticvox::graphics {
+class model_streamer;
+}
+
+namespace arcticvox::components {
+
+/**
+ * @class model_handle
+ * @brief Refers to a model that is loaded in the background by graphics::model_streamer
+ *
+ * @details The handle is returned immediately by the streamer and can be polled from any thread.
+ * A default constructed handle refers to no model.
+ */
+class model_handle final {
+  public:
+    enum class load_state : uint8_t {
+        loading,     //!< Import or upload still in progress
+        resident,    //!< The model is uploaded and can be drawn
+        failed       //!< The model could not be loaded, the reason was logged
+    };
+
+    model_handle() = default;
+
+    /**
+     * @brief Returns true if the handle refers to a load request
+     */
+    [[nodiscard]] bool valid() const {
+        return static_cast<bool>(state_);
+    }
+
+    [[nodiscard]] load_state state() const {
+        return state_ ? state_->state.load(std::memory_order_acquire) : load_state::failed;
+    }
+
+    /**
+     * @brief Returns the loaded model, or nullptr if it is not resident (yet)
+     */
+    [[nodiscard]] std::shared_ptr<model> get() const {
+        return (state() == load_state::resident) ? state_->loaded_model : nullptr;
+    }
+
+    void reset() {
+        state_.reset();
+    }
+
+  private:
+    friend class graphics::model_streamer;
+
+    /**
+     * @brief State shared between the handles and the loader thread
+     *
+     * @details loaded_model is written once before state is set to resident with release
+     * semantics, readers only access it after observing resident.
+     */
+    struct shared_state {
+        std::atomic<load_state> state {load_state::loading};
+        std::shared_ptr<model> loaded_model {};
+    };
+
+    explicit model_handle(std::shared_ptr<shared_state> state) : state_(std::move(state)) { }
+
+    std::shared_ptr<shared_state> state_ {};
+};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef ARCTICVOX_SUBMESH_HPP
+#define ARCTICVOX_SUBMESH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/matrix.hpp>
+
+#include "arcticvox/components/bounds.hpp"
+
+namespace arcticvox::components {
+
+/**
+ * @brief Index range of one simplified level of detail of a submesh
+ */
+struct submesh_lod {
+    uint32_t first_index = 0U;    //!< First index of the level in the index buffer
+    uint32_t index_count = 0U;    //!< Number of indices of the level
+    float error = 0.0f;           //!< Largest deviation from the full mesh, before transform
+};
+
+/**
+ * @brief Draw range of one mesh within a model's shared vertex and index buffers
+ *
+ * @details Indices are relative to vertex_offset, which is passed to the indexed draw. A mesh that
+ * is referenced by several nodes of the imported scene has one submesh per node, all sharing the
+ * same ranges.
+ *
+ * Simplified levels of detail follow all full meshes in the same index buffer and are drawn with
+ * the same vertex_offset. If meshlets were built, the full mesh's index range is the
+ * concatenation of its meshlets.
+ */
+struct submesh {
+    static constexpr std::size_t MAX_LODS = 3U;    //!< Simplified levels below the full mesh
+
+    uint32_t first_index = 0U;      //!< First index of the mesh in the index buffer
+    uint32_t index_count = 0U;      //!< Number of indices of the mesh
+    int32_t vertex_offset = 0;      //!< First vertex of the mesh in the vertex buffer
+    uint32_t material_id = 0U;      //!< Material index of the imported scene
+    aabb bounds {};                 //!< Bounds of the mesh's vertices, before transform
+    glm::mat4 transform {1.0f};     //!< Accumulated node transform into model space
+    uint32_t lod_count = 0U;        //!< Number of valid entries in lods
+    uint32_t first_meshlet = 0U;    //!< First meshlet of the full mesh
+    uint32_t meshlet_count = 0U;    //!< Number of meshlets, 0 if not built
+    //! Simplified levels sharing the mesh's vertices, from finest to coarsest
+    std::array<submesh_lod, MAX_LODS> lods {};
+
+    /**
+     * @brief Returns the index range of a level, 0 is the full mesh
+     */
+    [[nodiscard]] submesh_lod lod(const std::size_t level) const {
+        if(level == 0U)
+            return submesh_lod {.first_index = first_index, .index_count = index_count};
+        return lods[level - 1U];
+    }
+
+    /**
+     * @brief Returns the number of levels including the full mesh
+     */
+    [[nodiscard]] std::size_t level_count() const {
+        return lod_count + 1U;
+    }
+};
+static_assert(std::is_trivially_copyable_v<submesh>);
+
+}
+
+#endif
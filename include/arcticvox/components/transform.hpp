@@ -11,11 +11,11 @@ struct transform {
     //! rotation expressed as quaternion
     glm::quat rotation {1.0f, 0.0f, 0.0f, 0.0f};
     //! scale of the object
-    glm::vec3 scale;
+    glm::vec3 scale {1.0f};
     //! position in space
-    glm::vec3 translation;
+    glm::vec3 translation {0.0f};
 
-    glm::mat4 mat4() {
+    glm::mat4 mat4() const {
         glm::mat4 translate_mat = glm::translate(glm::mat4 {1.0f}, translation);
         glm::mat4 scale_mat = glm::scale(glm::mat4 {1.0f}, scale);
         glm::mat4 rot_mat = glm::toMat4(rotation);
@@ -0,0 +1,92 @@
+#ifndef ARCTICVOX_TRANSFORM_STORE_HPP
+#define ARCTICVOX_TRANSFORM_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+
+#include "arcticvox/components/transform.hpp"
+
+namespace arcticvox::components {
+
+/**
+ * @class transform_store
+ * @brief The transforms of all gameobjects stored as a structure of arrays, with their world
+ * matrices cached
+ *
+ * @details Setting a transform only marks it dirty, update() recomputes the world matrices of the
+ * dirty transforms and leaves all others untouched, so static objects cost nothing per frame. It
+ * composes eight matrices at a time with AVX, four with SSE2 and falls back to one at a time
+ * otherwise, selected when compiling.
+ */
+class transform_store final {
+  public:
+    //! Index of a transform, valid for the lifetime of the store
+    using handle = uint32_t;
+
+    /**
+     * @brief Adds a transform, its world matrix is computed by the next update()
+     */
+    [[nodiscard]] handle create(const transform& initial = {});
+
+    [[nodiscard]] transform get(handle id) const;
+
+    void set(handle id, const transform& value);
+    void set_translation(handle id, const glm::vec3& translation);
+    void set_rotation(handle id, const glm::quat& rotation);
+    void set_scale(handle id, const glm::vec3& scale);
+
+    /**
+     * @brief Recomputes the world matrices of all transforms set since the last update
+     */
+    void update();
+
+    /**
+     * @brief Returns the world matrix of the transform as of the last update()
+     */
+    [[nodiscard]] const glm::mat4& world_matrix(const handle id) const {
+        return world_[id];
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return world_.size();
+    }
+
+  private:
+    //! Transforms per word of the dirty bitset
+    static constexpr std::size_t WORD_BITS = 64U;
+
+    void mark_dirty(handle id);
+
+    /**
+     * @brief Composes the world matrices of the transforms from first on whose bits are set in
+     * lanes, all lanes of the vector width at once
+     */
+    void compose_wide(std::size_t first, uint64_t lanes);
+
+    /**
+     * @brief Composes the world matrices like compose_wide(), one at a time
+     */
+    void compose_scalar(std::size_t first, uint64_t lanes);
+
+    std::vector<float> translation_x_ {};
+    std::vector<float> translation_y_ {};
+    std::vector<float> translation_z_ {};
+    std::vector<float> rotation_x_ {};
+    std::vector<float> rotation_y_ {};
+    std::vector<float> rotation_z_ {};
+    std::vector<float> rotation_w_ {};
+    std::vector<float> scale_x_ {};
+    std::vector<float> scale_y_ {};
+    std::vector<float> scale_z_ {};
+    std::vector<uint64_t> dirty_ {};     //!< One bit per transform, set until the next update()
+    std::vector<glm::mat4> world_ {};    //!< Cached translation * rotation * scale
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef ARCTICVOX_VERTEX_HPP
 #define ARCTICVOX_VERTEX_HPP
 
+#include <cstdint>
 #include <vector>
 
 #include <vulkan/vulkan.hpp>
@@ -13,6 +14,14 @@
 
 namespace arcticvox::components {
 
+/**
+ * @brief Vertex layouts a model's vertex buffer can be stored in
+ */
+enum class vertex_format : uint8_t {
+    full,      //!< components::vertex, 32 bit floats
+    compact    //!< components::compact_vertex, quantised
+};
+
 class vertex {
   public:
     static std::vector<vk::VertexInputBindingDescription> get_binding_description();
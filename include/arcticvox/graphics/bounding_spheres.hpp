@@ -0,0 +1,55 @@
+#ifndef ARCTICVOX_BOUNDING_SPHERES_HPP
+#define ARCTICVOX_BOUNDING_SPHERES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "arcticvox/graphics/frustum.hpp"
+
+namespace arcticvox::graphics {
+
+/**
+ * @class bounding_spheres
+ * @brief World space bounding spheres stored as a structure of arrays, culled in bulk
+ *
+ * @details cull() tests eight spheres at a time with AVX, four with SSE2 and falls back to one at a
+ * time otherwise, selected when compiling. Spheres with an infinite radius are always visible.
+ */
+class bounding_spheres final {
+  public:
+    void clear();
+
+    void push_back(const glm::vec3& center, float radius);
+
+    [[nodiscard]] std::size_t size() const {
+        return radius_.size();
+    }
+
+    /**
+     * @brief Collects the spheres not completely outside of the frustum
+     *
+     * @param view_frustum The frustum, in the spheres' space
+     * @param visible Receives the indices of the visible spheres in ascending order, cleared first
+     */
+    void cull(const frustum& view_frustum, std::vector<uint32_t>& visible) const;
+
+  private:
+    /**
+     * @brief Tests the spheres from first on one at a time
+     */
+    void cull_scalar(const frustum& view_frustum,
+                     std::size_t first,
+                     std::vector<uint32_t>& visible) const;
+
+    std::vector<float> x_ {};
+    std::vector<float> y_ {};
+    std::vector<float> z_ {};
+    std::vector<float> radius_ {};
+};
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef ARCTICVOX_COMMAND_BUFFER_MANAGER_HPP
+#define ARCTICVOX_COMMAND_BUFFER_MANAGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace arcticvox::graphics {
+
+/**
+ * @class recycling_command_pool
+ * @brief Command pool whose command buffers are reset together and then handed out again
+ *
+ * @details Command buffers are only allocated if all existing ones of the requested level have
+ * been handed out since the last reset(). Like the command pool itself, the class is not thread
+ * safe.
+ */
+class recycling_command_pool final {
+  public:
+    recycling_command_pool(vk::raii::Device& device, uint32_t queue_family);
+
+    recycling_command_pool(const recycling_command_pool& other) = delete;
+    recycling_command_pool(recycling_command_pool&& other) = delete;
+
+    ~recycling_command_pool() = default;
+
+    recycling_command_pool& operator=(const recycling_command_pool& other) = delete;
+    recycling_command_pool& operator=(recycling_command_pool&& other) = delete;
+
+    /**
+     * @brief Returns a command buffer in the initial state
+     *
+     * @param level Whether a primary or a secondary command buffer is needed
+     * @return The command buffer, which stays valid until the pool is destroyed
+     */
+    [[nodiscard]] auto acquire(vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary)
+        -> vk::raii::CommandBuffer&;
+
+    /**
+     * @brief Resets all command buffers of the pool at once, none of them may be pending
+     */
+    auto reset() -> void;
+
+  private:
+    /**
+     * @brief The command buffers of one level, the first used of them are handed out
+     */
+    struct recycled_buffers {
+        std::deque<vk::raii::CommandBuffer> buffers {};    //!< Deque, references stay valid
+        std::size_t used = 0U;
+    };
+
+    vk::raii::Device& device_;
+    vk::raii::CommandPool pool_;
+    recycled_buffers primaries_ {};
+    recycled_buffers secondaries_ {};
+};
+
+/**
+ * @class command_buffer_manager
+ * @brief Hands out recycled command buffers from one pool per thread and slot
+ *
+ * @details A slot is typically a frame in flight. Every thread that records gets its own pool for
+ * every slot, so threads record in parallel without locking. Once the device is done with a slot,
+ * e.g. after its frame's fence was waited on, reset() resets the pools of all threads in bulk and
+ * their command buffers are reused.
+ */
+class command_buffer_manager final {
+  public:
+    /**
+     * @brief Creates the manager, pools are created on first use by each thread
+     *
+     * @param device The logical device
+     * @param queue_family The queue family the command buffers are submitted to
+     * @param slot_count The number of slots, e.g. swapchain::MAX_FRAMES_IN_FLIGHT
+     */
+    command_buffer_manager(vk::raii::Device& device, uint32_t queue_family, std::size_t slot_count);
+
+    command_buffer_manager(const command_buffer_manager& other) = delete;
+    command_buffer_manager(command_buffer_manager&& other) = delete;
+
+    ~command_buffer_manager() = default;
+
+    command_buffer_manager& operator=(const command_buffer_manager& other) = delete;
+    command_buffer_manager& operator=(command_buffer_manager&& other) = delete;
+
+    /**
+     * @brief Returns a command buffer of the calling thread's pool for the slot
+     *
+     * @param slot The slot, in [0, slot_count)
+     * @param level Whether a primary or a secondary command buffer is needed
+     * @return The command buffer in the initial state, valid until the manager is destroyed
+     */
+    [[nodiscard]] auto acquire(std::size_t slot,
+                               vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary)
+        -> vk::raii::CommandBuffer&;
+
+    /**
+     * @brief Resets the pools of all threads for the slot
+     *
+     * @details No command buffer of the slot may be pending or recorded while resetting.
+     */
+    auto reset(std::size_t slot) -> void;
+
+  private:
+    using slot_pools = std::vector<std::unique_ptr<recycling_command_pool>>;
+
+    vk::raii::Device& device_;
+    uint32_t queue_family_;
+    std::size_t slot_count_;
+
+    std::mutex mutex_;                                           //!< Guards threads_
+    std::unordered_map<std::thread::id, slot_pools> threads_;    //!< Each thread's pools per slot
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef ARCTICVOX_DEPTH_PYRAMID_HPP
+#define ARCTICVOX_DEPTH_PYRAMID_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/pipeline.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
+#include "arcticvox/io/shaderloader.hpp"
+
+namespace arcticvox::graphics {
+
+/**
+ * @class depth_pyramid
+ * @brief A mip chain of the farthest depth of a frame, for occlusion culling against it
+ *
+ * @details The first level has half the resolution of the depth attachment, every further level
+ * half of the one before, down to a single texel. A texel holds the farthest depth of all pixels
+ * it covers, so a box whose nearest depth lies behind it is hidden. Odd sizes are rounded up and
+ * the last texel of a level also covers the remainder, which keeps the pyramid conservative.
+ * Every frame in flight has a pyramid of its own, recreated when the depth attachment's size
+ * changes.
+ */
+class depth_pyramid final {
+  public:
+    /**
+     * @brief Creates the pipeline building the pyramids, the pyramids are created on first use
+     */
+    explicit depth_pyramid(gpu_driver& driver);
+
+    depth_pyramid(const depth_pyramid& other) = delete;
+    depth_pyramid(depth_pyramid&& other) = delete;
+
+    ~depth_pyramid() = default;
+
+    depth_pyramid& operator=(const depth_pyramid& other) = delete;
+    depth_pyramid& operator=(depth_pyramid&& other) = delete;
+
+    //! Levels of the largest pyramid, enough for depth attachments up to 65536 pixels wide
+    static constexpr uint32_t MAX_LEVELS = 16U;
+    //! Invocations per workgroup along each axis, matches the compute shader's local size
+    static constexpr uint32_t WORKGROUP_SIZE = 8U;
+
+    /**
+     * @brief Records building the frame's pyramid from the depth attachment
+     *
+     * @param command_buffer The command buffer to record into, outside of a render pass
+     * @param frame_index The frame in flight, whose pyramid is built
+     * @param depth The depth attachment, in the depth stencil attachment layout
+     *
+     * @details Leaves the depth attachment in the depth stencil read only layout and the pyramid
+     * in the general layout, readable by the compute shaders that follow.
+     */
+    auto build(vk::raii::CommandBuffer& command_buffer,
+               uint32_t frame_index,
+               const depth_attachment& depth) -> void;
+
+    /**
+     * @brief Returns the view of all levels of the frame's pyramid, built by build()
+     */
+    [[nodiscard]] auto view(const uint32_t frame_index) const -> vk::ImageView {
+        return *pyramids_.at(frame_index)->view;
+    }
+
+    [[nodiscard]] auto level_count(const uint32_t frame_index) const -> uint32_t {
+        return pyramids_.at(frame_index)->level_count;
+    }
+
+    /**
+     * @brief Returns the sampler to bind the pyramid with, it is only read with texelFetch
+     */
+    [[nodiscard]] auto sampler() const -> vk::Sampler {
+        return *sampler_;
+    }
+
+  private:
+    /**
+     * @brief The pyramid of a frame in flight
+     */
+    struct pyramid_image {
+        vk::raii::Image image;
+        memory_allocation memory;
+        vk::raii::ImageView view;                        //!< All levels
+        std::vector<vk::raii::ImageView> level_views;    //!< One per level
+        vk::raii::DescriptorSets descriptor_sets;        //!< One per level, writing the level
+        vk::Extent2D depth_extent;                       //!< Of the depth it is built from
+        uint32_t level_count;
+    };
+
+    auto create_descriptor_set_layout() -> vk::raii::DescriptorSetLayout;
+    auto create_pipeline_layout() -> vk::raii::PipelineLayout;
+    auto create_descriptor_pool() -> vk::raii::DescriptorPool;
+    auto create_sampler() -> vk::raii::Sampler;
+
+    /**
+     * @brief Creates a pyramid for a depth attachment of the extent
+     *
+     * @details Every level's descriptor set but the first is written, the first one reads the
+     * depth attachment, which is only known when building.
+     */
+    auto create_pyramid(vk::Extent2D depth_extent) -> pyramid_image;
+
+    const std::vector<char> pyramid_shader_ =
+        io::shader_loader::load_from_file("shaders/depth_pyramid.comp.spv");
+
+    gpu_driver& driver_;
+
+    vk::raii::DescriptorSetLayout descriptor_set_layout_;
+    vk::raii::PipelineLayout pipeline_layout_;
+    compute_pipeline pipeline_;
+    vk::raii::DescriptorPool descriptor_pool_;
+    vk::raii::Sampler sampler_;
+    std::array<std::optional<pyramid_image>, swapchain::MAX_FRAMES_IN_FLIGHT> pyramids_ {};
+};
+
+}
+
+#endif
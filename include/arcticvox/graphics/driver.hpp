@@ -1,15 +1,39 @@
 #ifndef ARCTICVOX_DRIVER_HPP
 #define ARCTICVOX_DRIVER_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 #include <vulkan/vulkan_enums.hpp>
 
+#include "arcticvox/graphics/command_buffer_manager.hpp"
+#include "arcticvox/graphics/geometry_arena.hpp"
 #include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/staging_ring.hpp"
 
 namespace arcticvox::graphics {
 
+/**
+ * @brief Host data to copy into a device buffer
+ */
+struct buffer_upload {
+    vk::Buffer destination;
+    const void* data;
+    vk::DeviceSize size;
+    vk::DeviceSize destination_offset = 0U;
+    //! Host address of the destination buffer if its memory is mapped, it is then written directly
+    std::byte* mapped_destination = nullptr;
+};
+
 class gpu_driver {
   public:
     gpu_driver(gpu& gpu);
@@ -22,20 +46,126 @@ class gpu_driver {
     gpu_driver& operator=(const gpu_driver& other) = delete;
     gpu_driver& operator=(gpu_driver&& other) = delete;
 
-    [[nodiscard]] auto bind_memory_to_buffer(
-        vk::raii::Buffer& buffer, vk::MemoryPropertyFlags properties) -> vk::raii::DeviceMemory;
+    /**
+     * @brief Sub-allocates memory for a buffer and binds it
+     *
+     * @param buffer The buffer to back with memory
+     * @param properties The properties the memory needs to have
+     * @return The allocation, which has to outlive the buffer's use by the device
+     */
+    [[nodiscard]] auto bind_memory_to_buffer(vk::raii::Buffer& buffer,
+                                             vk::MemoryPropertyFlags properties)
+        -> memory_allocation;
+
+    /**
+     * @brief Sub-allocates memory for an optimally tiled image and binds it
+     *
+     * @param image The image to back with memory
+     * @param properties The properties the memory needs to have
+     * @return The allocation, which has to outlive the image's use by the device
+     */
+    [[nodiscard]] auto bind_memory_to_image(const vk::raii::Image& image,
+                                            vk::MemoryPropertyFlags properties)
+        -> memory_allocation;
 
-    [[nodiscard]] auto begin_single_time_commands() -> vk::raii::CommandBuffer;
+    /**
+     * @brief Begins a recycled one time command buffer from the single time command pool
+     *
+     * @details The pool is shared by all threads, callers have to hold the lock returned by
+     * lock_uploads() until end_single_time_commands() has returned. The pool is reset there.
+     */
+    [[nodiscard]] auto begin_single_time_commands() -> vk::raii::CommandBuffer&;
 
+    /**
+     * @brief Copies between two buffers and blocks until the copy has finished
+     *
+     * @details Safe to call from any thread.
+     */
     auto copy_buffer(vk::raii::Buffer& src, vk::raii::Buffer& dst, vk::DeviceSize size) -> void;
 
     [[nodiscard]] auto create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage)
         -> vk::raii::Buffer;
 
+    /**
+     * @brief Copies host data into device buffers through the staging ring
+     *
+     * @param uploads The copies to perform, the host data is no longer needed on return
+     * @return The ticket to pass to wait_for_upload(), the copies may still be in flight
+     *
+     * @details All uploads are recorded into a single submission unless they do not fit into the
+     * ring at once, in which case the function waits for older uploads to make room. The copies run
+     * on the transfer queue, if the device has a transfer only family the ownership of the
+     * destination ranges is released there and acquired on the graphics queue. Once the ticket has
+     * been reached, the ranges are readable by any later graphics submission. Safe to call from
+     * any thread.
+     *
+     * Uploads into mapped destinations are written by the host before the function returns, they
+     * need no staging and no copy. Host coherent writes are visible to any later submission.
+     */
+    [[nodiscard]] auto upload_buffers(std::span<const buffer_upload> uploads) -> uint64_t;
+
+    /**
+     * @brief Blocks until the uploads of the ticket, and all uploads before them, have finished
+     *
+     * @details Safe to call from any thread.
+     */
+    auto wait_for_upload(uint64_t ticket) -> void;
+
     [[nodiscard]] auto device() -> vk::raii::Device& {
         return device_;
     }
 
+    /**
+     * @brief Returns the allocator all device memory of the engine is taken from
+     */
+    [[nodiscard]] auto allocator() -> memory_allocator& {
+        return allocator_;
+    }
+
+    /**
+     * @brief Returns the memory properties to create device local buffers with
+     *
+     * @details Includes host visible and host coherent if the device has a large device local
+     * memory type the host can map, as integrated GPUs and discrete ones with resizable BAR do.
+     * Buffers in it can be written without going through the staging ring.
+     */
+    [[nodiscard]] auto device_local_properties() const -> vk::MemoryPropertyFlags {
+        return device_local_properties_;
+    }
+
+    /**
+     * @brief Returns whether multiDrawIndirect and drawIndirectFirstInstance are enabled
+     *
+     * @details Both are needed to draw a whole scene, with every draw's first instance addressing
+     * its instance data, from one indirect buffer.
+     */
+    [[nodiscard]] auto multi_draw_indirect() const -> bool {
+        return multi_draw_indirect_;
+    }
+
+    /**
+     * @brief Returns whether drawIndirectCount is enabled
+     *
+     * @details Needed to draw commands whose number is only known to the device, such as those
+     * written by a culling compute pass.
+     */
+    [[nodiscard]] auto draw_indirect_count() const -> bool {
+        return draw_indirect_count_;
+    }
+
+    /**
+     * @brief Returns the vertex and index buffers the geometry of all models is stored in
+     */
+    [[nodiscard]] auto geometry() -> geometry_arena& {
+        return geometry_arena_;
+    }
+
+    /**
+     * @brief Submits a command buffer from begin_single_time_commands() and waits for its fence
+     *
+     * @details Only waits for the submitted commands, frames rendered concurrently keep running.
+     * The single time command pool is reset afterwards.
+     */
     auto end_single_time_commands(vk::raii::CommandBuffer& command_buffer) -> void;
 
     [[nodiscard]] auto graphics_queue() -> vk::raii::Queue& {
@@ -46,22 +176,109 @@ class gpu_driver {
         return present_queue_;
     }
 
-    [[nodiscard]] auto command_pool() -> vk::raii::CommandPool& {
-        return command_pool_;
+    /**
+     * @brief Returns the queue uploads are copied on, the graphics queue without a transfer family
+     */
+    [[nodiscard]] auto transfer_queue() -> vk::raii::Queue& {
+        return transfer_queue_;
+    }
+
+    [[nodiscard]] auto queue_families() const -> const queue_family_indices& {
+        return queue_families_;
+    }
+
+    /**
+     * @brief Returns the mutex every submission to, and wait on, the queues has to hold
+     *
+     * @details Vulkan requires external synchronisation of queues and models are uploaded from
+     * loader threads while the render thread submits frames.
+     */
+    [[nodiscard]] auto queue_mutex() -> std::mutex& {
+        return queue_mutex_;
+    }
+
+    /**
+     * @brief Locks the upload command pool used by the single time commands
+     */
+    [[nodiscard]] auto lock_uploads() -> std::unique_lock<std::mutex> {
+        return std::unique_lock {upload_mutex_};
     }
 
   private:
-    [[nodiscard]] auto create_command_pool() -> vk::raii::CommandPool;
+    /**
+     * @brief The command pools of a batch of staged uploads, reused once the batch has finished
+     */
+    struct upload_pools {
+        upload_pools(vk::raii::Device& device, uint32_t transfer_family, uint32_t graphics_family) :
+            transfer(device, transfer_family), graphics(device, graphics_family) { }
+
+        recycling_command_pool transfer;    //!< The copies and the release barriers
+        recycling_command_pool graphics;    //!< The acquire barriers
+        uint64_t ticket = 0U;               //!< The staging ring's ticket of the batch
+    };
 
     [[nodiscard]] auto create_device() -> vk::raii::Device;
 
+    /**
+     * @brief Selects device_local_properties(), preferring memory that is also host visible
+     */
+    [[nodiscard]] auto select_device_local_properties() const -> vk::MemoryPropertyFlags;
+
+    /**
+     * @brief Ends and submits a command buffer from begin_single_time_commands()
+     *
+     * @return The fence signalled once the command buffer has completed
+     */
+    [[nodiscard]] auto submit_single_time_commands(vk::raii::CommandBuffer& command_buffer)
+        -> vk::raii::Fence;
+
+    /**
+     * @brief Returns the command pools for the ring's current batch
+     *
+     * @details Resets the pools of all finished batches first, they are handed out again before
+     * new pools are created.
+     */
+    [[nodiscard]] auto begin_upload_batch() -> upload_pools&;
+
+    /**
+     * @brief Submits the copies of the ring's current batch and closes the batch
+     *
+     * @param pools The pools from begin_upload_batch()
+     * @param command_buffer The transfer command buffer with the copies, from the pools
+     * @param destinations The ranges written by the copies, to hand over to the graphics queue
+     * @return The ticket of the batch
+     */
+    auto submit_staged(upload_pools& pools,
+                       vk::raii::CommandBuffer& command_buffer,
+                       std::span<const vk::BufferMemoryBarrier> destinations) -> uint64_t;
+
     gpu& gpu_;
+    queue_family_indices queue_families_;
+    bool memory_budget_;            //!< Whether VK_EXT_memory_budget is enabled
+    bool multi_draw_indirect_;      //!< Whether the indirect draw features are enabled
+    bool draw_indirect_count_;      //!< Whether drawing a device written number of draws is enabled
     vk::raii::Device device_;
+    memory_allocator allocator_;    //!< Declared after the device so it is destroyed first
+    vk::MemoryPropertyFlags device_local_properties_;
 
     vk::raii::Queue graphics_queue_;
     vk::raii::Queue present_queue_;
+    vk::raii::Queue transfer_queue_;
+
+    //! Signalled by the copies, waited on by the acquire barriers on the graphics queue
+    vk::raii::Semaphore transfer_timeline_;
+
+    std::mutex queue_mutex_;     //!< Guards all queues
+    std::mutex upload_mutex_;    //!< Guards the upload pools and the ring
+
+    recycling_command_pool single_time_pool_;    //!< Reset after every single time submission
+    //! The pools of the batches in the staging ring, oldest batch first
+    std::deque<std::unique_ptr<upload_pools>> upload_pools_;
+    std::vector<std::unique_ptr<upload_pools>> free_upload_pools_;
 
-    vk::raii::CommandPool command_pool_;
+    //! Destroyed before the pools, it waits for the batches recorded into them
+    staging_ring staging_ring_;
+    geometry_arena geometry_arena_;
 };
 
 }
@@ -1,14 +1,22 @@
 #ifndef ARCTICVOX_ENGINE_HPP
 #define ARCTICVOX_ENGINE_HPP
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "arcticvox/common/engine_configuration.hpp"
 #include "arcticvox/components/gameobject.hpp"
+#include "arcticvox/components/transform_store.hpp"
 #include "arcticvox/graphics/camera.hpp"
 #include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/geometry_arena.hpp"
+#include "arcticvox/graphics/model_streamer.hpp"
 #include "arcticvox/graphics/render_system.hpp"
 #include "arcticvox/graphics/renderer.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
 #include "arcticvox/graphics/window.hpp"
 
 namespace arcticvox::graphics {
@@ -35,12 +43,74 @@ class graphics_engine {
         return window_;
     }
 
+    model_streamer& get_model_streamer() {
+        return streamer_;
+    }
+
+    components::transform_store& get_transforms() {
+        return transforms_;
+    }
+
+    /**
+     * @brief Selects how the draws are recorded, see render_system::set_submission()
+     */
+    void set_submission(const render_system::submission mode) {
+        render_sys_.set_submission(mode);
+    }
+
+    /**
+     * @brief Enables culling hidden submeshes with GPU culled submission, see
+     * render_system::set_occlusion_culling()
+     */
+    void set_occlusion_culling(const bool enabled) {
+        render_sys_.set_occlusion_culling(enabled);
+    }
+
+    /**
+     * @brief Enables culling back facing meshlets, see render_system::set_cone_culling()
+     */
+    void set_cone_culling(const bool enabled) {
+        render_sys_.set_cone_culling(enabled);
+    }
+
   private:
+    /**
+     * @brief Replaces the models of all gameobjects whose pending model became resident
+     *
+     * @param frame_index The frame in flight that is about to be recorded
+     *
+     * @details Replaced models may still be referenced by frames in flight, so they are kept
+     * alive until the same frame index is recorded again.
+     */
+    void swap_in_streamed_models(uint32_t frame_index);
+
+    /**
+     * @brief Compacts the geometry arena if it has become fragmented
+     *
+     * @param command_buffer The frame's command buffer, the copies are recorded before the render
+     * pass
+     * @param frame_index The frame in flight that is about to be recorded
+     *
+     * @details The replaced buffers are kept alive until the same frame index is recorded again.
+     */
+    void compact_geometry(vk::raii::CommandBuffer& command_buffer, uint32_t frame_index);
+
     window& window_;
     gpu gpu_;
     gpu_driver driver_;
     renderer renderer_;
+    components::transform_store transforms_ {};    //!< Of the gameobjects, updated every frame
     render_system render_sys_;
+    model_streamer streamer_;
+
+    //! models replaced during a frame, released once that frame's fence has been waited on again
+    std::array<std::vector<std::shared_ptr<components::model>>, swapchain::MAX_FRAMES_IN_FLIGHT>
+        retired_models_ {};
+    //! geometry buffers replaced by compaction during a frame, released like retired_models_
+    std::array<std::optional<geometry_arena::retired_buffers>, swapchain::MAX_FRAMES_IN_FLIGHT>
+        retired_geometry_ {};
+
+    uint64_t frame_number_ = 0U;    //!< Frames recorded so far
 
     camera* camera_ = nullptr;
 
@@ -0,0 +1,61 @@
+#ifndef ARCTICVOX_FRUSTUM_HPP
+#define ARCTICVOX_FRUSTUM_HPP
+
+#include <array>
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace arcticvox::graphics {
+
+/**
+ * @brief The six planes bounding the visible volume of a camera
+ *
+ * @details Plane normals point inwards and are normalised, so dot(normal, p) + w is the signed
+ * distance of p to the plane.
+ */
+struct frustum {
+    std::array<glm::vec4, 6U> planes {};    //!< Left, right, bottom, top, near and far plane
+
+    /**
+     * @brief Extracts the planes from a clip matrix
+     *
+     * @param clip The projection view matrix, or projection view model for a local frustum
+     *
+     * @details Follows Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from the
+     * World-View-Projection Matrix", for the Vulkan depth range of [0, 1].
+     */
+    [[nodiscard]] static frustum from_matrix(const glm::mat4& clip) {
+        const auto row = [&clip](const int i) {
+            return glm::vec4 {clip[0][i], clip[1][i], clip[2][i], clip[3][i]};
+        };
+
+        frustum result {};
+        result.planes = {row(3) + row(0),
+                         row(3) - row(0),
+                         row(3) + row(1),
+                         row(3) - row(1),
+                         row(2),
+                         row(3) - row(2)};
+        for(glm::vec4& plane: result.planes)
+            plane /= glm::length(glm::vec3 {plane});
+        return result;
+    }
+
+    /**
+     * @brief Returns false if the sphere lies completely outside of the frustum
+     */
+    [[nodiscard]] bool intersects_sphere(const glm::vec3& center, const float radius) const {
+        for(const glm::vec4& plane: planes) {
+            if(glm::dot(glm::vec3 {plane}, center) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef ARCTICVOX_GEOMETRY_ARENA_HPP
+#define ARCTICVOX_GEOMETRY_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/range_allocator.hpp"
+
+namespace arcticvox::graphics {
+
+class geometry_arena;
+
+/**
+ * @class geometry_allocation
+ * @brief Vertex and index range of a model within the geometry_arena, returned on destruction
+ *
+ * @details Offsets are read through the arena, compaction moves the ranges of uploaded models. A
+ * default constructed allocation is empty.
+ */
+class geometry_allocation final {
+  public:
+    geometry_allocation() = default;
+
+    geometry_allocation(const geometry_allocation& other) = delete;
+    geometry_allocation(geometry_allocation&& other) noexcept;
+
+    ~geometry_allocation();
+
+    geometry_allocation& operator=(const geometry_allocation& other) = delete;
+    geometry_allocation& operator=(geometry_allocation&& other) noexcept;
+
+    [[nodiscard]] explicit operator bool() const {
+        return arena_ != nullptr;
+    }
+
+    /**
+     * @brief Returns the offset of the vertex range in bytes, to upload to
+     */
+    [[nodiscard]] vk::DeviceSize vertex_offset() const;
+
+    /**
+     * @brief Returns the offset of the index range in bytes, to upload to
+     */
+    [[nodiscard]] vk::DeviceSize index_offset() const;
+
+    /**
+     * @brief Returns the index of the first vertex, the base to add to the draws' vertex offsets
+     */
+    [[nodiscard]] int32_t first_vertex() const;
+
+    /**
+     * @brief Returns the index of the first index, the base to add to the draws' first indices
+     */
+    [[nodiscard]] uint32_t first_index() const;
+
+    /**
+     * @brief Marks the data as uploaded, which allows compaction to move it
+     */
+    void mark_uploaded();
+
+    /**
+     * @brief Returns the ranges to the arena early, leaving the allocation empty
+     */
+    void reset();
+
+  private:
+    friend class geometry_arena;
+
+    struct entry {
+        vk::DeviceSize vertex_offset;
+        vk::DeviceSize vertex_size;
+        vk::DeviceSize vertex_stride;
+        vk::DeviceSize index_offset;
+        vk::DeviceSize index_size;
+        vk::DeviceSize index_stride;
+        bool uploaded = false;
+    };
+
+    geometry_arena* arena_ = nullptr;
+    std::list<entry>::iterator entry_ {};
+};
+
+/**
+ * @class geometry_arena
+ * @brief One vertex and one index buffer that the geometry of all models is sub-allocated from
+ *
+ * @details Models of both vertex formats share the vertex buffer, vertex ranges are aligned to the
+ * vertex size so that draws can address them by vertex index. Index ranges are aligned to the index
+ * size, the index buffer only has to be rebound when the index type changes.
+ *
+ * Freed ranges leave holes. Once enough of the free space is scattered in holes, compact() moves
+ * all uploaded ranges into new buffers back to back. The old buffers are handed to the caller,
+ * which keeps them alive until frames in flight no longer read from them.
+ *
+ * If the buffers' memory is host visible, models write their geometry into it directly.
+ *
+ * Allocating and freeing are thread safe, compaction and reading the buffers and offsets are
+ * reserved to the render thread.
+ */
+class geometry_arena final {
+  public:
+    static constexpr vk::DeviceSize DEFAULT_VERTEX_CAPACITY = 128ULL << 20U;    //!< 128 MiB
+    static constexpr vk::DeviceSize DEFAULT_INDEX_CAPACITY = 64ULL << 20U;      //!< 64 MiB
+    //! Compact once more than this share of a buffer is free but not part of its largest hole
+    static constexpr float COMPACTION_THRESHOLD = 0.25f;
+
+    /**
+     * @brief Buffers replaced by compact(), the device may still read from them
+     */
+    struct retired_buffers {
+        vk::raii::Buffer vertex_buffer;
+        memory_allocation vertex_memory;
+        vk::raii::Buffer index_buffer;
+        memory_allocation index_memory;
+    };
+
+    /**
+     * @brief Creates the buffers
+     *
+     * @param device The logical device
+     * @param allocator The allocator the buffers' memory is taken from
+     * @param properties The memory properties of the buffers, at least device local
+     * @param vertex_capacity The size of the vertex buffer
+     * @param index_capacity The size of the index buffer
+     */
+    geometry_arena(vk::raii::Device& device,
+                   memory_allocator& allocator,
+                   vk::MemoryPropertyFlags properties,
+                   vk::DeviceSize vertex_capacity = DEFAULT_VERTEX_CAPACITY,
+                   vk::DeviceSize index_capacity = DEFAULT_INDEX_CAPACITY);
+
+    geometry_arena(const geometry_arena& other) = delete;
+    geometry_arena(geometry_arena&& other) = delete;
+
+    ~geometry_arena() = default;
+
+    geometry_arena& operator=(const geometry_arena& other) = delete;
+    geometry_arena& operator=(geometry_arena&& other) = delete;
+
+    /**
+     * @brief Allocates the vertex and index range of a model
+     *
+     * @param vertex_size The size of the vertices in bytes
+     * @param vertex_stride The size of a single vertex
+     * @param index_size The size of the indices in bytes, may be 0
+     * @param index_stride The size of a single index
+     * @return The allocation, never empty
+     *
+     * @details Throws std::runtime_error if either buffer has no room left.
+     */
+    [[nodiscard]] auto allocate(vk::DeviceSize vertex_size,
+                                vk::DeviceSize vertex_stride,
+                                vk::DeviceSize index_size,
+                                vk::DeviceSize index_stride) -> geometry_allocation;
+
+    /**
+     * @brief Moves all uploaded ranges back to back into new buffers if the arena is fragmented
+     *
+     * @param command_buffer The frame's command buffer, outside of a render pass
+     * @return The old buffers if the arena was compacted
+     *
+     * @details Does nothing while uploads are pending, their copies target the current buffers.
+     */
+    [[nodiscard]] auto compact(vk::raii::CommandBuffer& command_buffer)
+        -> std::optional<retired_buffers>;
+
+    /**
+     * @brief Returns the allocated share of the fuller of the two buffers, between 0 and 1
+     */
+    [[nodiscard]] auto usage() const -> float;
+
+    /**
+     * @brief Returns whether an allocation has failed since the last call, resetting the flag
+     */
+    [[nodiscard]] auto take_allocation_failure() -> bool;
+
+    [[nodiscard]] auto vertex_buffer() const -> const vk::raii::Buffer& {
+        return vertex_buffer_;
+    }
+
+    [[nodiscard]] auto index_buffer() const -> const vk::raii::Buffer& {
+        return index_buffer_;
+    }
+
+    /**
+     * @brief Returns the host address of the vertex buffer, nullptr unless its memory is mapped
+     */
+    [[nodiscard]] auto vertex_data() const -> std::byte* {
+        return vertex_memory_.mapped();
+    }
+
+    /**
+     * @brief Returns the host address of the index buffer, nullptr unless its memory is mapped
+     */
+    [[nodiscard]] auto index_data() const -> std::byte* {
+        return index_memory_.mapped();
+    }
+
+  private:
+    friend class geometry_allocation;
+
+    auto free(geometry_allocation& allocation) -> void;
+
+    [[nodiscard]] auto is_fragmented() const -> bool;
+
+    [[nodiscard]] auto create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage) const
+        -> vk::raii::Buffer;
+
+    vk::raii::Device& device_;
+    memory_allocator& allocator_;
+    vk::MemoryPropertyFlags properties_;
+
+    vk::raii::Buffer vertex_buffer_;
+    memory_allocation vertex_memory_;
+    vk::raii::Buffer index_buffer_;
+    memory_allocation index_memory_;
+
+    mutable std::mutex mutex_;                         //!< Guards everything below
+    range_allocator vertex_ranges_;
+    range_allocator index_ranges_;
+    std::list<geometry_allocation::entry> entries_;    //!< Stable, allocations point into it
+    std::size_t pending_uploads_ = 0U;                 //!< Allocations not marked as uploaded
+    bool allocation_failed_ = false;                   //!< Set when the arena had no room
+};
+
+}
+
+#endif
@@ -32,6 +32,8 @@ struct queue_family_indices {
                                                 //!< graphics operations
     std::optional<uint32_t> present_family;     //!< The index to a queue family supporting
                                                 //!< presentation
+    std::optional<uint32_t> transfer_family;    //!< A transfer only queue family, copies on it
+                                                //!< run on the GPU's DMA engines
 
     /**
      * @brief Returns if queues were found that support both presentation and graphics operations
@@ -41,6 +43,15 @@ struct queue_family_indices {
     [[nodiscard]] bool is_complete() const {
         return graphics_family && present_family;
     }
+
+    /**
+     * @brief Returns the queue family uploads are submitted to
+     *
+     * @return The transfer only family if the device has one, the graphics family otherwise
+     */
+    [[nodiscard]] uint32_t upload_family() const {
+        return transfer_family.value_or(graphics_family.value());
+    }
 };
 
 class gpu {
@@ -82,6 +93,9 @@ class gpu {
      * @brief Checks whether the physical device supports the required extensions, features,
      * swapchain capabilities and queues
      *
+     * @details Uploads signal timeline semaphores, so the device has to support Vulkan 1.2 and the
+     * timelineSemaphore feature.
+     *
      * @param device The device to check for suitability
      * @param extensions The extensions to check for
      * @return True if the device is suitable
@@ -0,0 +1,226 @@
+#ifndef ARCTICVOX_GPU_CULLER_HPP
+#define ARCTICVOX_GPU_CULLER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "arcticvox/graphics/depth_pyramid.hpp"
+#include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/frustum.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/pipeline.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
+#include "arcticvox/io/shaderloader.hpp"
+
+namespace arcticvox::graphics {
+
+/**
+ * @class gpu_culler
+ * @brief Culls submeshes against the view frustum in a compute pass, writing their draw commands
+ *
+ * @details Every candidate is tested by one invocation. The visible candidates of a batch write
+ * their draw command to the front of the batch's commands and count themselves in the batch's
+ * draw count, so the commands are consumed with indirect count draws without the host ever
+ * reading them. The order of the visible commands within a batch is not preserved.
+ *
+ * With occlusion culling the frame is culled in two passes. The first draws what is in the frustum
+ * and passed the last occlusion test of the frame in flight. The second tests every candidate
+ * against the depth pyramid of what the first drew and draws those that became visible, whose
+ * commands and counts follow those of the first pass. It records the result for the next time.
+ */
+class gpu_culler final {
+  public:
+    /**
+     * @brief Creates the compute pipeline and the descriptor sets of all frames in flight
+     */
+    explicit gpu_culler(gpu_driver& driver);
+
+    gpu_culler(const gpu_culler& other) = delete;
+    gpu_culler(gpu_culler&& other) = delete;
+
+    ~gpu_culler() = default;
+
+    gpu_culler& operator=(const gpu_culler& other) = delete;
+    gpu_culler& operator=(gpu_culler&& other) = delete;
+
+    //! Invocations per workgroup, matches the compute shader's local size
+    static constexpr uint32_t WORKGROUP_SIZE = 64U;
+    //! Smallest number of candidates a frame's buffers are created for
+    static constexpr std::size_t MIN_CANDIDATE_CAPACITY = 1024U;
+
+    /**
+     * @brief A submesh of an object to cull, matches the compute shader's std430 layout
+     */
+    struct candidate {
+        glm::vec4 sphere;           //!< Bounding sphere in the space of the vertices, radius in w
+        glm::vec4 inverse_scale;    //!< Undoes the scale of the vertex transform per axis
+        uint32_t index_count;       //!< The vertex count for models without indices
+        uint32_t first_index;
+        int32_t vertex_offset;      //!< The first vertex for models without indices
+        uint32_t first_instance;    //!< Its instance, whose model matrix places the sphere
+        uint32_t batch;             //!< The draw count it is counted in
+        uint32_t first_command;     //!< The first command of its batch
+        uint32_t indexed;           //!< Whether the command is an indexed one
+        uint32_t padding;
+    };
+    static_assert(sizeof(candidate) == 64U, "The candidate has to match the shader's layout");
+
+    /**
+     * @brief Uploads the frame's candidates and records their culling
+     *
+     * @param command_buffer The command buffer to record into, outside of a render pass
+     * @param frame_index The frame in flight, whose buffers are written
+     * @param candidates The submeshes to cull, grouped into batches by their batch index
+     * @param batch_count The number of batches, one draw count each
+     * @param instances The frame's instance buffer, read for the model matrices
+     * @param view_frustum The camera's frustum in world space
+     * @param occlusion Whether only candidates that passed the last occlusion test are drawn,
+     * leaving the rest to record_occlusion()
+     *
+     * @details The draw counts of both passes are reset first, and the commands and counts are
+     * made available to the indirect draws that follow in the command buffer.
+     */
+    auto record(vk::raii::CommandBuffer& command_buffer,
+                uint32_t frame_index,
+                std::span<const candidate> candidates,
+                uint32_t batch_count,
+                vk::Buffer instances,
+                const frustum& view_frustum,
+                bool occlusion) -> void;
+
+    /**
+     * @brief Records testing the frame's candidates against the depth pyramid
+     *
+     * @param command_buffer The command buffer to record into, after the first pass' draws and
+     * outside of a render pass
+     * @param frame_index The frame in flight, culled by record() before
+     * @param pyramid The depth pyramid, built for the frame from the first pass' depth
+     * @param projection_view The camera's projection view matrix
+     * @param depth_extent The size of the depth attachment the pyramid was built from
+     *
+     * @details The commands of the candidates that became visible start at candidate_count(),
+     * their counts at the batch count.
+     */
+    auto record_occlusion(vk::raii::CommandBuffer& command_buffer,
+                          uint32_t frame_index,
+                          const depth_pyramid& pyramid,
+                          const glm::mat4& projection_view,
+                          vk::Extent2D depth_extent) -> void;
+
+    /**
+     * @brief Returns the number of candidates the frame culled
+     */
+    [[nodiscard]] auto candidate_count(const uint32_t frame_index) const -> uint32_t {
+        return frames_.at(frame_index).candidate_count;
+    }
+
+    /**
+     * @brief Returns a frame's draw commands, written by record()
+     */
+    [[nodiscard]] auto commands(const uint32_t frame_index) const -> vk::Buffer {
+        return *frames_.at(frame_index).commands->buffer;
+    }
+
+    /**
+     * @brief Returns a frame's draw counts, one uint32_t per batch and pass
+     */
+    [[nodiscard]] auto counts(const uint32_t frame_index) const -> vk::Buffer {
+        return *frames_.at(frame_index).counts->buffer;
+    }
+
+  private:
+    /**
+     * @brief The compute shader's push constants
+     */
+    struct push_constants {
+        std::array<glm::vec4, 6U> planes;
+        uint32_t candidate_count;
+        uint32_t occlusion;
+    };
+
+    /**
+     * @brief The occlusion compute shader's push constants
+     */
+    struct occlusion_push_constants {
+        glm::mat4 projection_view;
+        std::array<uint32_t, 2U> depth_size;
+        uint32_t candidate_count;
+        uint32_t batch_count;
+        uint32_t level_count;
+    };
+
+    /**
+     * @brief A buffer of a frame in flight, grown on demand
+     */
+    struct culling_buffer {
+        vk::raii::Buffer buffer;
+        memory_allocation memory;
+        vk::DeviceSize size;
+    };
+
+    /**
+     * @brief The buffers a frame in flight culls with
+     */
+    struct frame_resources {
+        std::optional<culling_buffer> candidates {};    //!< Host visible, written every frame
+        std::optional<culling_buffer> commands {};
+        std::optional<culling_buffer> counts {};
+        std::optional<culling_buffer> visibility {};    //!< Kept from frame to frame
+        uint32_t candidate_count = 0U;
+        uint32_t batch_count = 0U;
+    };
+
+    auto create_descriptor_set_layout() -> vk::raii::DescriptorSetLayout;
+    auto create_pyramid_set_layout() -> vk::raii::DescriptorSetLayout;
+    auto create_pipeline_layout() -> vk::raii::PipelineLayout;
+    auto create_occlusion_pipeline_layout() -> vk::raii::PipelineLayout;
+    auto create_descriptor_pool() -> vk::raii::DescriptorPool;
+
+    /**
+     * @brief Allocates one set of the layout per frame in flight
+     */
+    auto allocate_descriptor_sets(vk::DescriptorSetLayout layout) -> vk::raii::DescriptorSets;
+
+    /**
+     * @brief Returns a frame's buffer, recreated with at least size bytes if it is smaller
+     *
+     * @details The frame's fence has been waited on, so the device no longer uses the buffer.
+     */
+    auto reserve(std::optional<culling_buffer>& buffer,
+                 vk::DeviceSize size,
+                 vk::BufferUsageFlags usage,
+                 vk::MemoryPropertyFlags properties,
+                 vk::DeviceSize min_size) -> culling_buffer&;
+
+    const std::vector<char> cull_shader_ =
+        io::shader_loader::load_from_file("shaders/cull.comp.spv");
+    const std::vector<char> occlusion_shader_ =
+        io::shader_loader::load_from_file("shaders/occlusion_cull.comp.spv");
+
+    gpu_driver& driver_;
+
+    vk::raii::DescriptorSetLayout descriptor_set_layout_;
+    vk::raii::DescriptorSetLayout pyramid_set_layout_;
+    vk::raii::PipelineLayout pipeline_layout_;
+    vk::raii::PipelineLayout occlusion_pipeline_layout_;
+    compute_pipeline pipeline_;
+    compute_pipeline occlusion_pipeline_;
+    vk::raii::DescriptorPool descriptor_pool_;
+    vk::raii::DescriptorSets descriptor_sets_;    //!< One per frame in flight
+    vk::raii::DescriptorSets pyramid_sets_;       //!< One per frame in flight
+    std::array<frame_resources, swapchain::MAX_FRAMES_IN_FLIGHT> frames_ {};
+};
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef ARCTICVOX_MEMORY_ALLOCATOR_HPP
+#define ARCTICVOX_MEMORY_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/range_allocator.hpp"
+
+namespace arcticvox::graphics {
+
+class memory_allocator;
+
+/**
+ * @class memory_allocation
+ * @brief Range of device memory handed out by the memory_allocator, returned on destruction
+ *
+ * @details Resources bound to the range have to be destroyed, or at least no longer be in use by
+ * the device, before the allocation is released. A default constructed allocation is empty.
+ */
+class memory_allocation final {
+  public:
+    memory_allocation() = default;
+
+    memory_allocation(const memory_allocation& other) = delete;
+    memory_allocation(memory_allocation&& other) noexcept;
+
+    ~memory_allocation();
+
+    memory_allocation& operator=(const memory_allocation& other) = delete;
+    memory_allocation& operator=(memory_allocation&& other) noexcept;
+
+    [[nodiscard]] explicit operator bool() const {
+        return allocator_ != nullptr;
+    }
+
+    /**
+     * @brief Returns the device memory block the range lies in
+     */
+    [[nodiscard]] vk::DeviceMemory memory() const {
+        return memory_;
+    }
+
+    /**
+     * @brief Returns the offset of the range within memory(), to pass when binding resources
+     */
+    [[nodiscard]] vk::DeviceSize offset() const {
+        return offset_;
+    }
+
+    [[nodiscard]] vk::DeviceSize size() const {
+        return size_;
+    }
+
+    /**
+     * @brief Returns the host address of the range, nullptr if the memory is not host visible
+     *
+     * @details Host visible blocks stay mapped for their whole lifetime.
+     */
+    [[nodiscard]] std::byte* mapped() const {
+        return mapped_;
+    }
+
+    /**
+     * @brief Returns the range to the allocator early, leaving the allocation empty
+     */
+    void reset();
+
+  private:
+    friend class memory_allocator;
+
+    memory_allocator* allocator_ = nullptr;
+    std::size_t pool_ = 0U;         //!< Index of the pool the block belongs to
+    vk::DeviceMemory memory_ {};    //!< Identifies the block within the pool
+    vk::DeviceSize offset_ = 0U;
+    vk::DeviceSize size_ = 0U;
+    std::byte* mapped_ = nullptr;
+};
+
+/**
+ * @class memory_allocator
+ * @brief Sub-allocates device memory from large per memory type blocks
+ *
+ * @details Vulkan implementations limit the number of live device memory allocations and every
+ * vkAllocateMemory() call is slow, so resources share blocks of block_size bytes. Every memory type
+ * has two pools, one for buffers and one for optimally tiled images, which keeps linear and
+ * non-linear resources apart and makes bufferImageGranularity irrelevant.
+ *
+ * Within a block, ranges are handed out by a range_allocator, i.e. best fit with freed ranges
+ * merged with their neighbours. Requests larger than half a block get a dedicated block of their
+ * own. Empty blocks are released, except for the last one of
+ * every pool, which avoids reallocating a block when a single resource is recreated.
+ *
+ * The usage of every memory heap is tracked against its budget. With VK_EXT_memory_budget both
+ * come from the driver and include what other resources of the process use, without it the
+ * allocator counts its own blocks against a share of the heap's size. A block that would exceed
+ * the budget first releases the spare empty blocks of the heap.
+ *
+ * All functions are thread safe.
+ */
+class memory_allocator final {
+  public:
+    static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64ULL << 20U;    //!< 64 MiB
+    //! Share of a heap's size used as its budget if VK_EXT_memory_budget is not supported
+    static constexpr float FALLBACK_BUDGET_SHARE = 0.8f;
+
+    /**
+     * @brief Whether a resource is a buffer, or an image with optimal tiling
+     */
+    enum class resource_kind : uint8_t {
+        linear,     //!< Buffers and linearly tiled images
+        optimal     //!< Optimally tiled images
+    };
+
+    /**
+     * @brief Memory usage of the allocator
+     */
+    struct statistics {
+        std::size_t block_count = 0U;           //!< Live device memory allocations
+        std::size_t allocation_count = 0U;      //!< Live sub-allocations
+        vk::DeviceSize reserved_bytes = 0U;     //!< Total size of all blocks
+        vk::DeviceSize allocated_bytes = 0U;    //!< Total size of all sub-allocations
+    };
+
+    /**
+     * @brief Budget and usage of a memory heap
+     */
+    struct heap_budget {
+        vk::DeviceSize budget = 0U;    //!< Bytes the process can allocate without paging
+        vk::DeviceSize usage = 0U;     //!< Bytes the process has allocated
+    };
+
+    /**
+     * @brief Creates the allocator
+     *
+     * @param gpu The physical device to allocate from
+     * @param device The logical device
+     * @param memory_budget Whether VK_EXT_memory_budget is enabled on the device
+     * @param block_size The size of the shared blocks
+     */
+    memory_allocator(gpu& gpu,
+                     vk::raii::Device& device,
+                     bool memory_budget,
+                     vk::DeviceSize block_size = DEFAULT_BLOCK_SIZE);
+
+    memory_allocator(const memory_allocator& other) = delete;
+    memory_allocator(memory_allocator&& other) = delete;
+
+    /**
+     * @brief Releases all blocks, every allocation has to be gone by now
+     */
+    ~memory_allocator() = default;
+
+    memory_allocator& operator=(const memory_allocator& other) = delete;
+    memory_allocator& operator=(memory_allocator&& other) = delete;
+
+    /**
+     * @brief Allocates memory fulfilling the requirements of a resource
+     *
+     * @param requirements The resource's size, alignment and allowed memory types
+     * @param properties The properties the memory type needs to have
+     * @param kind The kind of resource the memory is bound to
+     * @return The allocation, never empty
+     *
+     * @details Throws std::runtime_error if no memory type fits or the device is out of memory.
+     */
+    [[nodiscard]] auto allocate(const vk::MemoryRequirements& requirements,
+                                vk::MemoryPropertyFlags properties,
+                                resource_kind kind) -> memory_allocation;
+
+    [[nodiscard]] auto get_statistics() const -> statistics;
+
+    /**
+     * @brief Returns the budget and usage of every memory heap, indexed like the device's heaps
+     */
+    [[nodiscard]] auto get_heap_budgets() const -> std::vector<heap_budget>;
+
+    /**
+     * @brief Returns the budget of the largest device local heap
+     */
+    [[nodiscard]] auto device_local_budget() const -> vk::DeviceSize;
+
+  private:
+    friend class memory_allocation;
+
+    struct block {
+        vk::raii::DeviceMemory memory;
+        vk::DeviceSize size;
+        std::byte* mapped;                    //!< Host address, nullptr if unmapped
+        range_allocator ranges;
+        std::size_t allocation_count = 0U;    //!< Live sub-allocations
+    };
+
+    struct pool {
+        uint32_t memory_type;
+        std::vector<std::unique_ptr<block>> blocks {};
+    };
+
+    auto free(memory_allocation& allocation) -> void;
+
+    auto create_block(pool& target, vk::DeviceSize size) -> block&;
+
+    /**
+     * @brief Returns the budget of a heap, the lock has to be held
+     */
+    [[nodiscard]] auto query_heap_budget(uint32_t heap) const -> heap_budget;
+
+    /**
+     * @brief Releases the empty blocks kept around in all pools of a heap, the lock has to be held
+     */
+    auto release_empty_blocks(uint32_t heap) -> void;
+
+    [[nodiscard]] auto heap_of(const pool& source) const -> uint32_t {
+        return memory_properties_.memoryTypes[source.memory_type].heapIndex;
+    }
+
+    gpu& gpu_;
+    vk::raii::Device& device_;
+    vk::DeviceSize block_size_;
+    bool memory_budget_;
+    vk::PhysicalDeviceMemoryProperties memory_properties_;
+
+    mutable std::mutex mutex_;                  //!< Guards the pools and all of their blocks
+    std::vector<pool> pools_;                   //!< Two pools per memory type, see resource_kind
+    std::size_t allocation_count_ = 0U;         //!< Live sub-allocations over all pools
+    vk::DeviceSize allocated_bytes_ = 0U;       //!< Size of all live sub-allocations
+    std::vector<vk::DeviceSize> heap_usage_;    //!< Size of all blocks per heap
+};
+
+}
+
+#endif
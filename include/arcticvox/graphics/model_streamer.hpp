@@ -0,0 +1,137 @@
+#ifndef ARCTICVOX_MODEL_STREAMER_HPP
+#define ARCTICVOX_MODEL_STREAMER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "arcticvox/common/thread_pool.hpp"
+#include "arcticvox/components/model.hpp"
+#include "arcticvox/components/model_handle.hpp"
+#include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/io/model_builder.hpp"
+
+namespace arcticvox::graphics {
+
+/**
+ * @class model_streamer
+ * @brief Imports and uploads models on background threads
+ *
+ * @details load() returns a handle immediately, the import and the upload run on the streamer's
+ * own worker pool. The engine swaps resident models into their gameobjects at frame boundaries.
+ *
+ * The streamer also manages the residency of the models it loaded. Once the geometry arena fills
+ * up, models that have not been drawn for EVICTION_FRAMES frames are evicted, least recently drawn
+ * first. Evicted models that are about to be drawn again are reimported, which usually hits the
+ * mesh cache, and uploaded in the background.
+ */
+class model_streamer final {
+  public:
+    //! Frames a model has to go undrawn before it can be evicted, longer than frames stay in flight
+    static constexpr uint64_t EVICTION_FRAMES = 120U;
+    //! Share of the geometry arena that eviction brings the usage down to
+    static constexpr float RESIDENCY_TARGET = 0.85f;
+
+    /**
+     * @brief Starts the loader threads
+     *
+     * @param driver The driver used to upload the models
+     * @param thread_count The number of loader threads, 0 uses one per hardware thread
+     */
+    explicit model_streamer(gpu_driver& driver, std::size_t thread_count = 0U);
+
+    model_streamer(const model_streamer& other) = delete;
+    model_streamer(model_streamer&& other) = delete;
+
+    /**
+     * @brief Finishes all outstanding loads
+     */
+    ~model_streamer() = default;
+
+    model_streamer& operator=(const model_streamer& other) = delete;
+    model_streamer& operator=(model_streamer&& other) = delete;
+
+    /**
+     * @brief Queues a model for import and upload
+     *
+     * @param filepath The model file, relative paths are resolved against the executable
+     * @param settings Builder holding the import settings, e.g. optimise_meshes
+     * @return A handle which becomes resident once the model is uploaded
+     */
+    [[nodiscard]] components::model_handle load(const std::filesystem::path& filepath,
+                                                io::model_builder settings = {});
+
+    /**
+     * @brief Returns a small cube which can be drawn while the actual model is loading
+     *
+     * @details Created on first use and shared between all callers.
+     */
+    [[nodiscard]] std::shared_ptr<components::model> placeholder();
+
+    /**
+     * @brief Returns the number of loads that have not finished yet
+     */
+    [[nodiscard]] std::size_t pending_count() const {
+        std::lock_guard lock {pending_mutex_};
+        return pending_count_;
+    }
+
+    /**
+     * @brief Blocks until all queued loads have finished
+     */
+    void wait_idle();
+
+    /**
+     * @brief Evicts idle models if the geometry arena is too full and restores requested ones
+     *
+     * @param frame The number of the frame about to be recorded, counting up from 0
+     *
+     * @details Called by the render thread once per frame, after the frame's fence was waited on.
+     * A failed allocation in the arena halves the usage target for the next call.
+     */
+    void update_residency(uint64_t frame);
+
+  private:
+    /**
+     * @brief A model loaded by the streamer, with what is needed to reimport it
+     */
+    struct tracked_model {
+        std::weak_ptr<components::model> model;
+        std::filesystem::path filepath;
+        io::model_builder settings;    //!< The import settings, without any data
+        uint64_t last_drawn = 0U;      //!< The last frame the model was drawn in
+        uint64_t next_restore = 0U;    //!< Earliest frame to retry a restore after a request
+    };
+
+    void finish_load();
+
+    /**
+     * @brief Reimports and uploads an evicted model on the worker pool
+     */
+    void restore(std::shared_ptr<components::model> target, const tracked_model& tracked);
+
+    gpu_driver& driver_;
+
+    std::mutex placeholder_mutex_;                         //!< Guards placeholder_
+    std::shared_ptr<components::model> placeholder_ {};    //!< Lazily created cube
+
+    mutable std::mutex pending_mutex_;                     //!< Guards pending_count_
+    std::condition_variable idle_;                         //!< Signalled when nothing is pending
+    std::size_t pending_count_ = 0U;                       //!< Loads queued or running
+
+    std::mutex tracked_mutex_;                             //!< Guards tracked_
+    std::vector<tracked_model> tracked_;                   //!< All models loaded by load()
+    std::atomic<uint64_t> frame_ {0U};                     //!< The frame of the last update
+
+    //! declared last, so the workers are joined before anything they reference is destroyed
+    thread_pool workers_;
+};
+
+}
+
+#endif
@@ -25,6 +25,8 @@ struct pipeline_config_info {
     vk::PipelineDepthStencilStateCreateInfo depth_stencil_info {};
     std::vector<vk::DynamicState> dynamic_states_enabled {};
     vk::PipelineDynamicStateCreateInfo dynamic_state_info {};
+    std::vector<vk::VertexInputBindingDescription> binding_descriptions {};
+    std::vector<vk::VertexInputAttributeDescription> attribute_descriptions {};
 
     vk::PipelineLayout pipeline_layout {};
     vk::RenderPass render_pass {};
@@ -92,6 +94,49 @@ class pipeline {
     vk::raii::Pipeline pipeline_;                      //!< The underlying vulkan pipeline object
 };
 
+class compute_pipeline {
+  public:
+    /**
+     * @brief Constructs the compute pipeline object
+     *
+     * @param driver The driver interface for the GPU that is being used
+     * @param compute_shader The compute shader to use
+     * @param pipeline_layout The layout of the shader's descriptor sets and push constants
+     */
+    compute_pipeline(gpu_driver& driver,
+                     const std::vector<char>& compute_shader,
+                     vk::PipelineLayout pipeline_layout);
+
+    compute_pipeline(const compute_pipeline& other) = delete;
+    compute_pipeline(compute_pipeline&& other) = delete;
+
+    ~compute_pipeline() = default;
+
+    compute_pipeline& operator=(const compute_pipeline& other) = delete;
+    compute_pipeline& operator=(compute_pipeline&& other) = delete;
+
+    /**
+     * @brief Returns the underlying vulkan pipeline
+     */
+    [[nodiscard]] auto vk_pipeline() -> vk::raii::Pipeline& {
+        return pipeline_;
+    };
+
+  private:
+    /**
+     * @brief Creates a vulkan compute pipeline running the shader module
+     *
+     * @param pipeline_layout The layout to create the pipeline with
+     * @return A vulkan pipeline
+     */
+    [[nodiscard]] auto create_pipeline(vk::PipelineLayout pipeline_layout) -> vk::raii::Pipeline;
+
+    gpu_driver& driver_;                              //!< The driver to interface with the gpu
+    vk::raii::ShaderModule compute_shader_module_;    //!< The compute shader module
+
+    vk::raii::Pipeline pipeline_;                     //!< The underlying vulkan pipeline object
+};
+
 }
 
 #endif
@@ -0,0 +1,59 @@
+#ifndef ARCTICVOX_RANGE_ALLOCATOR_HPP
+#define ARCTICVOX_RANGE_ALLOCATOR_HPP
+
+#include <map>
+#include <optional>
+
+#include <vulkan/vulkan.hpp>
+
+namespace arcticvox::graphics {
+
+/**
+ * @class range_allocator
+ * @brief Hands out aligned ranges of a fixed size address space, e.g. a memory block or a buffer
+ *
+ * @details Free ranges are kept in an offset ordered list, allocations take the best fitting range
+ * and freed ranges are merged with their neighbours. The allocator only does the bookkeeping and
+ * is not thread safe.
+ */
+class range_allocator final {
+  public:
+    explicit range_allocator(vk::DeviceSize size);
+
+    /**
+     * @brief Allocates a range
+     *
+     * @param size The size of the range
+     * @param alignment The alignment of the range's offset, does not need to be a power of two
+     * @return The offset of the range, std::nullopt if no free range is large enough
+     */
+    [[nodiscard]] auto allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+        -> std::optional<vk::DeviceSize>;
+
+    /**
+     * @brief Returns a range handed out by allocate()
+     */
+    auto free(vk::DeviceSize offset, vk::DeviceSize size) -> void;
+
+    [[nodiscard]] auto size() const -> vk::DeviceSize {
+        return size_;
+    }
+
+    [[nodiscard]] auto free_bytes() const -> vk::DeviceSize {
+        return free_bytes_;
+    }
+
+    /**
+     * @brief Returns the size of the largest free range, the largest allocation that could succeed
+     */
+    [[nodiscard]] auto largest_free_range() const -> vk::DeviceSize;
+
+  private:
+    vk::DeviceSize size_;
+    vk::DeviceSize free_bytes_;
+    std::map<vk::DeviceSize, vk::DeviceSize> free_;    //!< Free ranges, offset to size
+};
+
+}
+
+#endif
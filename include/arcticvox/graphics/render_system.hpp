@@ -1,23 +1,55 @@
 #ifndef ARCTICVOX_RENDER_SYSTEM_HPP
 #define ARCTICVOX_RENDER_SYSTEM_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
+#include <glm/mat4x4.hpp>
+
+#include "arcticvox/common/radix_sort.hpp"
+#include "arcticvox/common/thread_pool.hpp"
+#include "arcticvox/components/camera_uniform.hpp"
 #include "arcticvox/components/gameobject.hpp"
+#include "arcticvox/components/submesh.hpp"
+#include "arcticvox/components/transform_store.hpp"
+#include "arcticvox/graphics/bounding_spheres.hpp"
 #include "arcticvox/graphics/camera.hpp"
+#include "arcticvox/graphics/command_buffer_manager.hpp"
+#include "arcticvox/graphics/depth_pyramid.hpp"
 #include "arcticvox/graphics/driver.hpp"
 #include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/gpu_culler.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
 #include "arcticvox/graphics/pipeline.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
 #include "arcticvox/io/shaderloader.hpp"
 
 namespace arcticvox::graphics {
 
 class render_system final {
   public:
-    render_system(gpu& gpu, gpu_driver& driver, vk::raii::RenderPass& renderpass);
+    /**
+     * @brief Creates the pipelines
+     *
+     * @param gpu The physical device
+     * @param driver The logical device
+     * @param renderpass The render pass the pipelines draw in
+     * @param command_buffers The renderer's command pools, secondary command buffers are taken
+     * from them
+     * @param transforms The transforms of the gameobjects, updated before each frame is recorded
+     */
+    render_system(gpu& gpu,
+                  gpu_driver& driver,
+                  vk::raii::RenderPass& renderpass,
+                  command_buffer_manager& command_buffers,
+                  components::transform_store& transforms);
 
     render_system(const render_system& other) = delete;
     render_system(render_system&& other) = delete;
@@ -27,24 +59,333 @@ class render_system final {
 
     ~render_system() = default;
 
+    //! Largest simplification error accepted on screen when picking a level of detail, in pixels
+    static constexpr float LOD_ERROR_THRESHOLD = 1.0f;
+    //! Smallest number of instances a frame's instance buffer is created for
+    static constexpr std::size_t MIN_INSTANCE_CAPACITY = 1024U;
+    //! Smallest number of draws a frame's indirect buffer is created for
+    static constexpr std::size_t MIN_DRAW_CAPACITY = 1024U;
+    //! Fewest draws worth recording into a secondary command buffer of their own
+    static constexpr std::size_t MIN_DRAWS_PER_SECONDARY = 256U;
+
+    /**
+     * @brief How the draws of a frame are recorded
+     */
+    enum class submission {
+        direct,        //!< One draw command per draw
+        indirect,      //!< One indirect draw per batch of draws sharing a pipeline and index buffer
+        parallel,      //!< Direct draws, recorded into secondary command buffers on worker threads
+        gpu_culled,    //!< Culled by a compute pass, one indirect count draw per batch
+    };
+
+    /**
+     * @brief Records the draws of all gameobjects with a model
+     *
+     * @param command_buffer The command buffer to record into, inside the render pass
+     * @param gameobjects The objects to draw
+     * @param cam The camera to draw from
+     * @param extent The size of the render target, used to project simplification errors
+     * @param frame_index The frame in flight, whose instance and indirect buffers are written
+     * @param inheritance The render pass instance secondary command buffers are executed in
+     *
+     * @details The bounding spheres of all submeshes of all objects are culled against the view
+     * frustum in one vectorised pass, submeshes outside of it are skipped. Every other submesh is
+     * drawn with the coarsest level of detail whose error projects to at most LOD_ERROR_THRESHOLD
+     * pixels. Gameobjects sharing a model are drawn together, one instanced draw per submesh and
+     * level of detail, with their transforms and colours read from the frame's instance buffer. A
+     * submesh drawn at full detail by a single object that was split into meshlets is culled per
+     * meshlet, by frustum and, if enabled, by normal cone, and consecutive visible meshlets are
+     * drawn together.
+     *
+     * The draws are collected first and radix sorted by a 64 bit key, by pipeline, index type,
+     * material and then front to back, so that few bindings change and early depth tests reject
+     * much of what is hidden. They are then recorded as selected by set_submission(). Indirect
+     * submission records a handful of commands per frame, however many objects are drawn. Parallel
+     * submission splits the draws into consecutive ranges, which worker threads record into
+     * secondary command buffers that the command buffer then executes in order. The render pass
+     * has to be begun with subpass_contents() then.
+     *
+     * With GPU culled submission, the draws were already prepared by cull_gameobjects() and only
+     * the indirect count draws of its batches are recorded.
+     */
     void render_gameobjects(vk::raii::CommandBuffer& command_buffer,
                             std::vector<components::gameobject>& gameobjects,
-                            camera& cam);
+                            camera& cam,
+                            vk::Extent2D extent,
+                            uint32_t frame_index,
+                            const vk::CommandBufferInheritanceInfo& inheritance);
+
+    /**
+     * @brief Culls the submeshes of all gameobjects on the device when GPU culling is selected
+     *
+     * @param command_buffer The command buffer to record into, outside of the render pass
+     * @param gameobjects The objects to draw
+     * @param cam The camera to draw from
+     * @param frame_index The frame in flight, whose instance buffer is written
+     *
+     * @details Has to be called before render_gameobjects() each frame, does nothing for the other
+     * submissions. The host only writes one instance and one culling candidate per object and
+     * submesh. A compute pass tests them against the view frustum and writes the draw commands of
+     * the visible ones, together with their counts, for render_gameobjects() to draw. All submeshes
+     * are drawn at full detail, in no particular order within their batch, and meshlets are not
+     * culled. Models in use are kept resident whether they are visible or not.
+     */
+    void cull_gameobjects(vk::raii::CommandBuffer& command_buffer,
+                          std::vector<components::gameobject>& gameobjects,
+                          camera& cam,
+                          uint32_t frame_index);
+
+    /**
+     * @brief Culls the submeshes the first pass skipped against its depth, when occlusion culling
+     *
+     * @param command_buffer The command buffer to record into, after the render pass that drew
+     * render_gameobjects() ended
+     * @param frame_index The frame in flight, culled by cull_gameobjects() before
+     * @param depth The depth attachment render_gameobjects() drew into
+     *
+     * @details Builds the depth pyramid of what was drawn and tests every submesh against it. Those
+     * that were skipped but are visible are drawn by render_disoccluded() in a render pass that
+     * resumes the first, all the others are remembered for the frame in flight's next culling.
+     */
+    void cull_occluded(vk::raii::CommandBuffer& command_buffer,
+                       uint32_t frame_index,
+                       const depth_attachment& depth);
+
+    /**
+     * @brief Draws the submeshes cull_occluded() found visible, does nothing without occlusion
+     * culling
+     */
+    void render_disoccluded(vk::raii::CommandBuffer& command_buffer, uint32_t frame_index);
+
+    /**
+     * @brief Enables or disables culling meshlets that face away from the camera
+     *
+     * @details The pipelines draw back faces, so the cone test is only invisible for closed meshes
+     * and should be disabled for scenes with open, double sided geometry. Enabled by default.
+     */
+    void set_cone_culling(const bool enabled) {
+        cone_culling_ = enabled;
+    }
+
+    /**
+     * @brief Selects how the draws are recorded, indirect by default where supported
+     *
+     * @details Falls back to direct submission if the device lacks multi draw indirect, and keeps
+     * the current submission if GPU culling is selected without draw indirect count support.
+     * Selecting parallel submission starts the recording threads on first use, selecting GPU
+     * culled submission creates the culling pipeline.
+     */
+    void set_submission(submission mode);
+
+    [[nodiscard]] submission get_submission() const {
+        return submission_;
+    }
+
+    /**
+     * @brief Enables or disables culling submeshes hidden behind what was drawn, off by default
+     *
+     * @details Only takes effect with GPU culled submission. Each frame then draws the submeshes
+     * that passed the frame in flight's last occlusion test first, and those that became visible
+     * after cull_occluded(). The depth pyramid is created on first use.
+     */
+    void set_occlusion_culling(bool enabled);
+
+    /**
+     * @brief Returns whether the frame is culled in two passes, with cull_occluded()
+     */
+    [[nodiscard]] bool occlusion_culling() const {
+        return occlusion_culling_ && (submission_ == submission::gpu_culled);
+    }
+
+    /**
+     * @brief Returns the contents to begin the render pass with for the selected submission
+     */
+    [[nodiscard]] vk::SubpassContents subpass_contents() const {
+        return (submission_ == submission::parallel) ? vk::SubpassContents::eSecondaryCommandBuffers
+                                                     : vk::SubpassContents::eInline;
+    }
 
   private:
+    /**
+     * @brief Host visible buffer written by the host every frame, one per frame in flight
+     */
+    struct frame_buffer {
+        vk::raii::Buffer buffer;
+        memory_allocation memory;
+        vk::DeviceSize size;
+    };
+
+    /**
+     * @brief What orders a draw besides its pipeline and index type
+     */
+    struct sort_criteria {
+        uint32_t material;      //!< The submesh's material
+        float depth;            //!< View space depth of the nearest instance
+        uint32_t model_rank;    //!< Orders the models of the frame, keeping their draws together
+    };
+
+    /**
+     * @brief A draw collected for the frame, before sorting
+     */
+    struct queued_draw {
+        vk::DrawIndexedIndirectCommand command;
+        components::vertex_format format;
+        std::optional<vk::IndexType> index_type;
+    };
+
+    /**
+     * @brief Consecutive draws of the frame sharing a pipeline and index buffer binding
+     */
+    struct draw_batch {
+        components::vertex_format format;
+        std::optional<vk::IndexType> index_type;    //!< Empty for models without indices
+        uint32_t first_draw;                        //!< Index into draws_
+        uint32_t draw_count;
+    };
+
+    vk::raii::DescriptorSetLayout create_camera_set_layout();
     vk::raii::PipelineLayout create_pipeline_layout();
-    std::unique_ptr<pipeline> create_pipeline(vk::raii::RenderPass& renderpass);
+    vk::raii::DescriptorPool create_descriptor_pool();
+    vk::raii::DescriptorSets allocate_camera_sets();
+    std::unique_ptr<pipeline> create_pipeline(vk::raii::RenderPass& renderpass,
+                                              components::vertex_format format);
+
+    /**
+     * @brief Sorts the gameobjects with a model by their model into draw_order_
+     *
+     * @return The number of instances the objects take at most, one per object and submesh
+     */
+    auto sort_by_model(std::vector<components::gameobject>& gameobjects) -> std::size_t;
+
+    /**
+     * @brief Returns one past the last object in draw_order_ sharing the model of group_begin
+     */
+    [[nodiscard]] auto end_of_group(std::size_t group_begin) const -> std::size_t;
+
+    /**
+     * @brief Returns the frame's instance buffer, with room for at least count instances
+     */
+    auto reserve_instances(uint32_t frame_index, std::size_t count) -> frame_buffer&;
+
+    /**
+     * @brief Queues a draw of a resident model together with its sort key
+     */
+    auto add_draw(const components::model& model,
+                  const vk::DrawIndexedIndirectCommand& command,
+                  const sort_criteria& criteria) -> void;
+
+    /**
+     * @brief Sorts the queued draws by their keys into draws_ and partitions them into batches_
+     */
+    auto sort_draws() -> void;
+
+    /**
+     * @brief Binds the vertex buffers and the camera's descriptor set shared by all draws of the
+     * frame
+     */
+    auto bind_frame_state(vk::raii::CommandBuffer& command_buffer,
+                          vk::Buffer instances,
+                          uint32_t frame_index) -> void;
+
+    /**
+     * @brief Records a range of the frame's draws, binding pipelines and index buffers as needed
+     *
+     * @param command_buffer The command buffer to record into, with the frame state bound
+     * @param first_draw The first draw of the range, an index into draws_
+     * @param last_draw One past the last draw of the range
+     * @param indirect_buffer The frame's indirect buffer holding draws_, null to draw directly
+     *
+     * @details Only reads the render system's state, so ranges can be recorded concurrently.
+     */
+    auto record_draws(vk::raii::CommandBuffer& command_buffer,
+                      std::size_t first_draw,
+                      std::size_t last_draw,
+                      vk::Buffer indirect_buffer) -> void;
+
+    /**
+     * @brief Records the frame's draws into secondary command buffers on the recording threads
+     *
+     * @details The secondary command buffers are executed by command_buffer in the order of the
+     * draws.
+     */
+    auto record_secondaries(vk::raii::CommandBuffer& command_buffer,
+                            uint32_t frame_index,
+                            vk::Extent2D extent,
+                            const vk::CommandBufferInheritanceInfo& inheritance,
+                            vk::Buffer instances) -> void;
+
+    /**
+     * @brief Records one indirect count draw per batch of the commands written by the culling pass
+     *
+     * @details Draws the commands of the occlusion pass if disoccluded is set.
+     */
+    auto record_culled_draws(vk::raii::CommandBuffer& command_buffer,
+                             uint32_t frame_index,
+                             bool disoccluded) -> void;
+
+    /**
+     * @brief Returns a frame's buffer, recreated with at least size bytes if it is smaller
+     *
+     * @param buffer The frame's buffer, empty before its first use
+     * @param size The number of bytes the frame writes
+     * @param usage The usage of the buffer
+     * @param min_size The smallest size to create the buffer with
+     *
+     * @details The frame's fence has been waited on, so the device no longer reads the buffer.
+     */
+    auto reserve_frame_buffer(std::optional<frame_buffer>& buffer,
+                              vk::DeviceSize size,
+                              vk::BufferUsageFlags usage,
+                              vk::DeviceSize min_size) -> frame_buffer&;
 
     const std::vector<char> fgt_shader_ =
         io::shader_loader::load_from_file("shaders/fragment_shader.frag.spv");
     const std::vector<char> vtx_shader_ =
         io::shader_loader::load_from_file("shaders/vertex_shader.vert.spv");
+    const std::vector<char> compact_vtx_shader_ =
+        io::shader_loader::load_from_file("shaders/compact_vertex_shader.vert.spv");
 
     gpu& gpu_;
     gpu_driver& driver_;
+    command_buffer_manager& command_buffers_;
+    components::transform_store& transforms_;    //!< Read for the world matrices of the objects
 
+    vk::raii::DescriptorSetLayout camera_set_layout_;
     vk::raii::PipelineLayout pipeline_layout_;
-    std::unique_ptr<pipeline> pipeline_;
+    vk::raii::DescriptorPool descriptor_pool_;
+    vk::raii::DescriptorSets camera_sets_;          //!< One per frame in flight
+    std::unique_ptr<pipeline> pipeline_;            //!< Draws models with full vertices
+    std::unique_ptr<pipeline> compact_pipeline_;    //!< Draws models with compact vertices
+    bool cone_culling_ = true;                      //!< Cull back facing meshlets
+    submission submission_;
+    uint32_t max_draw_indirect_count_;              //!< Most draws a single indirect draw may hold
+
+    //! Grown on demand, one per frame in flight so that no frame overwrites what the device reads
+    std::array<std::optional<frame_buffer>, swapchain::MAX_FRAMES_IN_FLIGHT> instance_buffers_ {};
+    std::array<std::optional<frame_buffer>, swapchain::MAX_FRAMES_IN_FLIGHT> indirect_buffers_ {};
+    std::array<std::optional<frame_buffer>, swapchain::MAX_FRAMES_IN_FLIGHT> camera_buffers_ {};
+    std::vector<vk::DrawIndexedIndirectCommand> draws_ {};    //!< The frame's draws, in order
+    std::vector<draw_batch> batches_ {};                      //!< Partition draws_, or GPU culled
+    std::vector<queued_draw> queued_draws_ {};                //!< The frame's draws, unsorted
+
+    radix_sorter sorter_ {};
+    std::vector<uint64_t> sort_keys_ {};      //!< Keys of the objects or draws being sorted
+    std::vector<uint32_t> sort_values_ {};    //!< Their indices, in sorted order after sorting
+
+    std::unique_ptr<thread_pool> recording_workers_ {};    //!< Started by parallel submission
+    std::vector<vk::CommandBuffer> secondaries_ {};        //!< The frame's, in order of the draws
+    std::unique_ptr<gpu_culler> gpu_culler_ {};            //!< Created by GPU culled submission
+    std::vector<gpu_culler::candidate> candidates_ {};     //!< The frame's, batch by batch
+    bool occlusion_culling_ = false;
+    std::unique_ptr<depth_pyramid> depth_pyramid_ {};      //!< Created by occlusion culling
+    glm::mat4 culled_projection_view_ {1.0f};              //!< The frame's, for the occlusion pass
+    //! Per level of detail, the visible objects of the submesh being drawn, reused every frame
+    std::array<std::vector<std::size_t>, components::submesh::MAX_LODS + 1U> lod_buckets_ {};
+    std::array<float, components::submesh::MAX_LODS + 1U> lod_depths_ {};    //!< Of each bucket
+    std::vector<components::gameobject*> draw_order_ {};    //!< Objects sorted by model
+    std::vector<glm::mat4> model_matrices_ {};              //!< Of the objects in draw_order_
+    bounding_spheres spheres_ {};                           //!< Per model, submesh and object
+    std::vector<uint32_t> visible_ {};                      //!< Indices of the visible spheres
 };
 }
 
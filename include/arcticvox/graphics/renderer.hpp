@@ -6,6 +6,7 @@
 
 #include <vulkan/vulkan_raii.hpp>
 
+#include "arcticvox/graphics/command_buffer_manager.hpp"
 #include "arcticvox/graphics/driver.hpp"
 #include "arcticvox/graphics/gpu.hpp"
 #include "arcticvox/graphics/swapchain.hpp"
@@ -26,27 +27,82 @@ class renderer final {
 
     [[nodiscard]] vk::raii::CommandBuffer* begin_frame();
 
-    void begin_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer);
+    /**
+     * @brief Begins the swapchain's render pass on the frame's command buffer
+     *
+     * @param command_buffer The frame's command buffer from begin_frame()
+     * @param contents Whether the render pass is recorded inline or by secondary command buffers,
+     * which then set the viewport and scissor themselves
+     */
+    void begin_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer,
+                                    vk::SubpassContents contents = vk::SubpassContents::eInline);
+
+    /**
+     * @brief Begins the swapchain's render pass again, drawing on top of what it drew before
+     *
+     * @param command_buffer The frame's command buffer from begin_frame()
+     *
+     * @details The depth attachment has to be in the depth stencil read only layout, see
+     * swapchain::resume_render_pass(). The render pass is recorded inline.
+     */
+    void resume_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer);
+
+    /**
+     * @brief Returns the depth attachment the current frame renders to
+     */
+    [[nodiscard]] depth_attachment current_depth_attachment() {
+        if(!is_frame_started_)
+            throw std::runtime_error("Cannot get depth attachment when frame is not in progress");
+        return swapchain_->get_depth_attachment(current_image_index_);
+    }
+
+    /**
+     * @brief Returns the inheritance of secondary command buffers executed in the swapchain's
+     * render pass during the current frame
+     */
+    [[nodiscard]] vk::CommandBufferInheritanceInfo swapchain_inheritance();
 
     [[nodiscard]] vk::raii::CommandBuffer& current_command_buffer() {
         if(!is_frame_started_)
             throw std::runtime_error("Cannot get command buffer when frame is not in progess");
-        return command_buffers_.at(current_frame_index_);
+        return *current_command_buffer_;
     }
 
     void end_frame();
 
     void end_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer);
 
+    /**
+     * @brief Returns the index of the current frame in flight, in [0, MAX_FRAMES_IN_FLIGHT)
+     */
+    [[nodiscard]] uint32_t frame_index() const {
+        return current_frame_index_;
+    }
+
     [[nodiscard]] swapchain& get_swapchain() {
         return *swapchain_;
     }
 
-  private:
-    [[nodiscard]] vk::raii::CommandBuffers create_command_buffers(std::size_t count);
+    /**
+     * @brief Returns the per thread and per frame command pools of the graphics queue
+     *
+     * @details Command buffers acquired for frame_index() may be recorded on any thread while the
+     * frame is in progress, the frame's pools are reset when it is begun again.
+     */
+    [[nodiscard]] command_buffer_manager& command_buffers() {
+        return command_buffers_;
+    }
 
+  private:
     void recreate_swapchain();
 
+    /**
+     * @brief Begins a render pass on the current framebuffer, clearing it if the pass clears
+     */
+    void begin_renderpass(vk::raii::CommandBuffer& command_buffer,
+                          vk::RenderPass render_pass,
+                          vk::SubpassContents contents);
+
     gpu& gpu_;
     gpu_driver& driver_;
     window& window_;
@@ -54,7 +110,8 @@ class renderer final {
 
     std::unique_ptr<swapchain> swapchain_;
 
-    vk::raii::CommandBuffers command_buffers_;
+    command_buffer_manager command_buffers_;
+    vk::raii::CommandBuffer* current_command_buffer_ = nullptr;    //!< The frame's primary
 
     uint32_t current_image_index_ = 0U;
     uint32_t current_frame_index_ = 0U;
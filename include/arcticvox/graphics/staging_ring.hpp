@@ -0,0 +1,150 @@
+#ifndef ARCTICVOX_STAGING_RING_HPP
+#define ARCTICVOX_STAGING_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/memory_allocator.hpp"
+
+namespace arcticvox::graphics {
+
+/**
+ * @class staging_ring
+ * @brief Persistently mapped host visible buffer that all uploads are staged through
+ *
+ * @details Space is handed out front to back and wraps around at the end of the buffer. Everything
+ * allocated between two calls to submit() forms a batch. Every batch has a ticket, the value the
+ * ring's timeline semaphore is signalled with once the device is done with the batch, and its
+ * space is released when the semaphore has reached that value.
+ *
+ * The ring is not thread safe, gpu_driver guards it with its upload lock.
+ */
+class staging_ring final {
+  public:
+    static constexpr vk::DeviceSize DEFAULT_SIZE = 32ULL << 20U;    //!< 32 MiB
+    static constexpr vk::DeviceSize DEFAULT_ALIGNMENT = 16U;
+
+    /**
+     * @brief Space allocated from the ring
+     */
+    struct region {
+        vk::DeviceSize offset;    //!< Offset into buffer(), the source offset of copies
+        std::byte* data;          //!< Host address to write the data to
+    };
+
+    staging_ring(vk::raii::Device& device,
+                 memory_allocator& allocator,
+                 vk::DeviceSize size = DEFAULT_SIZE);
+
+    staging_ring(const staging_ring& other) = delete;
+    staging_ring(staging_ring&& other) = delete;
+
+    /**
+     * @brief Waits for all batches still in flight
+     */
+    ~staging_ring();
+
+    staging_ring& operator=(const staging_ring& other) = delete;
+    staging_ring& operator=(staging_ring&& other) = delete;
+
+    [[nodiscard]] auto buffer() const -> const vk::raii::Buffer& {
+        return buffer_;
+    }
+
+    [[nodiscard]] auto size() const -> vk::DeviceSize {
+        return size_;
+    }
+
+    /**
+     * @brief Returns the timeline semaphore the submissions of a batch have to signal
+     */
+    [[nodiscard]] auto timeline() const -> const vk::raii::Semaphore& {
+        return timeline_;
+    }
+
+    /**
+     * @brief Returns the ticket of the current batch, the value to signal timeline() with
+     */
+    [[nodiscard]] auto next_ticket() const -> uint64_t {
+        return next_ticket_;
+    }
+
+    /**
+     * @brief Returns the ticket of the most recently submitted batch, 0 if there was none
+     */
+    [[nodiscard]] auto last_ticket() const -> uint64_t {
+        return next_ticket_ - 1U;
+    }
+
+    /**
+     * @brief Returns the ticket of the most recently released batch, all batches up to it are done
+     */
+    [[nodiscard]] auto released_ticket() const -> uint64_t {
+        return released_ticket_;
+    }
+
+    /**
+     * @brief Allocates space for the current batch
+     *
+     * @param size The number of bytes, at most size()
+     * @param alignment The alignment of the returned offset
+     * @return The region, std::nullopt if the ring is full until batches in flight have finished
+     */
+    [[nodiscard]] auto allocate(vk::DeviceSize size,
+                                vk::DeviceSize alignment = DEFAULT_ALIGNMENT)
+        -> std::optional<region>;
+
+    /**
+     * @brief Closes the current batch, whose last submission signals timeline() with next_ticket()
+     *
+     * @return The ticket to wait() for the batch with
+     */
+    auto submit() -> uint64_t;
+
+    /**
+     * @brief Releases the space of all batches that have finished, without blocking
+     */
+    auto retire() -> void;
+
+    /**
+     * @brief Blocks until the batch with the ticket and all batches before it have finished
+     */
+    auto wait(uint64_t ticket) -> void;
+
+    /**
+     * @brief Blocks until the oldest batch in flight has finished
+     *
+     * @return False if there was no batch in flight
+     */
+    auto wait_oldest() -> bool;
+
+  private:
+    struct batch {
+        uint64_t ticket;
+        uint64_t end;    //!< Position of the ring's head at submission
+    };
+
+    auto release_front() -> void;
+
+    vk::raii::Device& device_;
+    vk::DeviceSize size_;
+    vk::raii::Buffer buffer_;
+    memory_allocation memory_;
+    vk::raii::Semaphore timeline_;
+
+    //! Head and tail count bytes since creation, modulo size_ they are offsets into the buffer
+    uint64_t head_ = 0U;
+    uint64_t tail_ = 0U;
+    uint64_t next_ticket_ = 1U;
+    uint64_t released_ticket_ = 0U;
+    std::deque<batch> in_flight_;    //!< Oldest batch first
+};
+
+}
+
+#endif
@@ -15,9 +15,20 @@
 
 #include "arcticvox/graphics/driver.hpp"
 #include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
 
 namespace arcticvox::graphics {
 
+/**
+ * @brief A depth image of the swapchain, which the render pass keeps for sampling afterwards
+ */
+struct depth_attachment {
+    vk::Image image;
+    vk::ImageView view;             //!< Depth aspect only, for sampling
+    vk::ImageAspectFlags aspect;    //!< Depth, and stencil if the format has it
+    vk::Extent2D extent;
+};
+
 class swapchain final {
   public:
     static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2U;
@@ -55,6 +66,16 @@ class swapchain final {
         return *swapchain_framebuffers_[index];
     }
 
+    /**
+     * @brief Returns the depth attachment of the framebuffer at index
+     */
+    [[nodiscard]] depth_attachment get_depth_attachment(const uint32_t index) const {
+        return depth_attachment {.image = *depth_images_.at(index),
+                                 .view = *depth_image_views_.at(index),
+                                 .aspect = depth_aspect_,
+                                 .extent = swapchain_extent_};
+    }
+
     [[nodiscard]] vk::Extent2D get_extent() const {
         return swapchain_extent_;
     }
@@ -66,6 +87,17 @@ class swapchain final {
         return render_pass_;
     }
 
+    /**
+     * @brief Returns the render pass continuing to draw into what render_pass() drew
+     *
+     * @details Loads the colour and depth attachments instead of clearing them and expects the
+     * depth attachment in the depth stencil read only layout, after it has been sampled. It is
+     * compatible with render_pass(), so the same pipelines and framebuffers are used with it.
+     */
+    [[nodiscard]] auto resume_render_pass() -> vk::raii::RenderPass& {
+        return resume_render_pass_;
+    }
+
     auto reset_fence() -> void {
         driver_.get().device().resetFences(*in_flight_fences_[current_frame_]);
     }
@@ -106,14 +138,19 @@ class swapchain final {
         -> std::vector<vk::raii::ImageView>;
 
     [[nodiscard]] auto create_device_memories(std::size_t count) const
-        -> std::vector<vk::raii::DeviceMemory>;
+        -> std::vector<memory_allocation>;
 
     [[nodiscard]] auto create_fences(std::size_t count) const -> std::vector<vk::raii::Fence>;
 
     [[nodiscard]] auto create_framebuffers(std::size_t count) const
         -> std::vector<vk::raii::Framebuffer>;
 
-    [[nodiscard]] auto create_renderpass() -> vk::raii::RenderPass;
+    /**
+     * @brief Creates the swapchain's render pass
+     *
+     * @param resume Whether the render pass continues on the attachments of a previous one
+     */
+    [[nodiscard]] auto create_renderpass(bool resume) -> vk::raii::RenderPass;
 
     [[nodiscard]] auto create_semaphores(std::size_t count) const
         -> std::vector<vk::raii::Semaphore>;
@@ -142,10 +179,12 @@ class swapchain final {
     std::vector<vk::raii::ImageView> swapchain_image_views_;
 
     vk::raii::RenderPass render_pass_;
+    vk::raii::RenderPass resume_render_pass_;
 
     vk::Format depth_image_format_;
+    vk::ImageAspectFlags depth_aspect_;
     std::vector<vk::raii::Image> depth_images_;
-    std::vector<vk::raii::DeviceMemory> depth_image_memories_;
+    std::vector<memory_allocation> depth_image_memories_;
     std::vector<vk::raii::ImageView> depth_image_views_;
 
     std::vector<vk::raii::Semaphore> image_available_semaphores_;
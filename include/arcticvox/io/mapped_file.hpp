@@ -0,0 +1,63 @@
+#ifndef ARCTICVOX_MAPPED_FILE_HPP
+#define ARCTICVOX_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+
+namespace arcticvox::io {
+
+/**
+ * @class mapped_file
+ * @brief Read-only memory mapping of a whole file
+ *
+ * @details The mapping is released when the object is destroyed. A file that could not be opened
+ * or mapped results in an invalid object, which can be checked with is_open().
+ */
+class mapped_file final {
+  public:
+    /**
+     * @brief Maps the file at the provided path into memory
+     *
+     * @param path The path of the file to map
+     */
+    explicit mapped_file(const std::filesystem::path& path);
+
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+
+    ~mapped_file();
+
+    mapped_file& operator=(const mapped_file& other) = delete;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    /**
+     * @brief Returns true if the file was mapped successfully
+     */
+    [[nodiscard]] bool is_open() const {
+        return data_ != nullptr;
+    }
+
+    /**
+     * @brief Returns a pointer to the first byte of the mapping
+     */
+    [[nodiscard]] const std::byte* data() const {
+        return data_;
+    }
+
+    /**
+     * @brief Returns the size of the mapping in bytes
+     */
+    [[nodiscard]] std::size_t size() const {
+        return size_;
+    }
+
+  private:
+    void unmap();
+
+    const std::byte* data_ = nullptr;    //!< Start of the mapped memory
+    std::size_t size_ = 0U;              //!< Size of the mapped memory in bytes
+};
+
+}
+
+#endif
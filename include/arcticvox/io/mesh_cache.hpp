@@ -0,0 +1,117 @@
+#ifndef ARCTICVOX_MESH_CACHE_HPP
+#define ARCTICVOX_MESH_CACHE_HPP
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <type_traits>
+
+namespace arcticvox::io {
+
+struct model_builder;
+
+/**
+ * @brief On-disk header of a cached mesh
+ *
+ * @details The header is followed by the vertex array at vertex_offset, the index array at
+ * index_offset, the submesh table at submesh_offset and the meshlet table at meshlet_offset. All
+ * offsets are aligned to 16 bytes relative to the start of the file.
+ */
+struct mesh_cache_header {
+    uint32_t magic;                       //!< Always mesh_cache::MAGIC
+    uint32_t version;                     //!< Format version the file was written with
+    uint64_t source_hash;                 //!< Content hash of the source model file
+    uint64_t source_size;                 //!< Size of the source model file in bytes
+    uint32_t vertex_stride;               //!< Size of one vertex in bytes
+    uint32_t flags;                       //!< Import settings the data was produced with
+    uint64_t vertex_count;                //!< Number of vertices stored in the file
+    uint64_t vertex_offset;               //!< Byte offset of the vertex array
+    uint64_t index_count;                 //!< Number of 32 bit indices stored in the file
+    uint64_t index_offset;                //!< Byte offset of the index array
+    uint64_t submesh_count;               //!< Number of components::submesh entries
+    uint64_t submesh_offset;              //!< Byte offset of the submesh table
+    uint64_t meshlet_count;               //!< Number of components::meshlet entries
+    uint64_t meshlet_offset;              //!< Byte offset of the meshlet table
+    std::array<float, 3U> bounds_min;    //!< Minimum corner of the mesh bounds
+    std::array<float, 3U> bounds_max;    //!< Maximum corner of the mesh bounds
+};
+static_assert(std::is_trivially_copyable_v<mesh_cache_header>);
+
+/**
+ * @class mesh_cache
+ * @brief Versioned binary cache of imported meshes
+ *
+ * @details Imported meshes are written to <exe dir>/cache/<content hash>_<flags>.avxmesh after the
+ * first import. Later loads of a file with the same content map the cache file and copy the vertex
+ * and index arrays straight into the model builder, which skips the importer entirely.
+ */
+class mesh_cache final {
+  public:
+    static constexpr uint32_t MAGIC = 0x48534D41U;    //!< "AMSH" in little endian
+    static constexpr uint32_t VERSION = 5U;           //!< Bump whenever the imported data changes
+
+    static constexpr uint32_t FLAG_OPTIMISED = 1U << 0U;    //!< Meshes ran through mesh_optimiser
+    static constexpr uint32_t FLAG_LODS = 1U << 1U;         //!< Submeshes carry simplified levels
+    static constexpr uint32_t FLAG_MESHLETS = 1U << 2U;     //!< Meshes were split into meshlets
+
+    /**
+     * @brief Returns the cache file path used for a source file with the provided hash
+     *
+     * @param source_hash The content hash of the source file
+     * @param flags The import settings, differently imported variants are cached side by side
+     * @return The path of the cache file, which might not exist yet
+     */
+    [[nodiscard]] static std::filesystem::path cache_path(uint64_t source_hash, uint32_t flags);
+
+    /**
+     * @brief Computes the content hash of a file
+     *
+     * @param path The path of the file to hash
+     * @return The hash or std::nullopt if the file could not be read
+     */
+    [[nodiscard]] static std::optional<uint64_t> hash_file(const std::filesystem::path& path);
+
+    /**
+     * @brief Tries to fill the builder from a cache file
+     *
+     * @param cache_file The cache file to load
+     * @param source_hash The content hash of the source file the cache has to match
+     * @param source_size The size of the source file in bytes, the cache has to match
+     * @param flags The import settings the cache has to match
+     * @param builder The builder to fill
+     * @return True if the cache file was valid and the builder was filled
+     *
+     * @details Cache files with a different magic, version, vertex layout, source hash, source
+     * size or flags are rejected, as are truncated files and files whose submeshes or meshlets
+     * reach past their indices or vertices. The builder is only modified on success.
+     */
+    [[nodiscard]] static bool load(const std::filesystem::path& cache_file,
+                                   uint64_t source_hash,
+                                   uint64_t source_size,
+                                   uint32_t flags,
+                                   model_builder& builder);
+
+    /**
+     * @brief Writes the builder's data to a cache file
+     *
+     * @param cache_file The cache file to write
+     * @param source_hash The content hash of the source file
+     * @param source_size The size of the source file in bytes
+     * @param flags The import settings the data was produced with
+     * @param builder The builder holding the imported data
+     * @return True if the cache file was written
+     *
+     * @details The data is written to a temporary file first which is then renamed, so a
+     * concurrently running instance never maps a partially written file.
+     */
+    static bool store(const std::filesystem::path& cache_file,
+                      uint64_t source_hash,
+                      uint64_t source_size,
+                      uint32_t flags,
+                      const model_builder& builder);
+};
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef ARCTICVOX_MESH_SIMPLIFIER_HPP
+#define ARCTICVOX_MESH_SIMPLIFIER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "arcticvox/components/vertex.hpp"
+
+namespace arcticvox::io {
+
+/**
+ * @brief Outcome of simplifying a single mesh
+ */
+struct simplification_result {
+    std::size_t index_count = 0U;    //!< Number of indices written to the destination
+    float error = 0.0f;              //!< Largest deviation from the input surface, in mesh units
+};
+
+/**
+ * @class mesh_simplifier
+ * @brief Reduces the triangle count of indexed triangle lists for lower levels of detail
+ *
+ * @details Simplification collapses edges onto one of their existing vertices, so the result
+ * addresses the same vertex range as the input and can share the vertex buffer with it.
+ */
+class mesh_simplifier final {
+  public:
+    /**
+     * @brief Simplifies one mesh towards a target index count
+     *
+     * @param destination Receives the simplified triangle list, at least as large as indices
+     * @param indices The triangle list of the mesh
+     * @param vertices The vertices addressed by the indices
+     * @param target_index_count The number of indices to reduce the mesh to
+     * @param target_error Collapses that would exceed this error, in mesh units, are not made
+     * @return The number of indices written and the error of the simplified mesh
+     *
+     * @details Uses quadric error metrics (Garland and Heckbert, "Surface Simplification Using
+     * Quadric Error Metrics", 1997) with area weighted face quadrics and constraint planes along
+     * open borders. Collapses happen in passes over the cheapest edges, no vertex is touched
+     * twice per pass and collapses that would flip a triangle are rejected.
+     *
+     * Border vertices only move along their border. Vertices on attribute seams, i.e. positions
+     * shared by several vertices with different normals, colours or uvs, are never moved, which
+     * keeps seams closed at the cost of limiting how far heavily seamed meshes can be reduced.
+     */
+    static simplification_result simplify(
+        std::span<uint32_t> destination,
+        std::span<const uint32_t> indices,
+        std::span<const components::vertex> vertices,
+        std::size_t target_index_count,
+        float target_error = std::numeric_limits<float>::max());
+};
+
+}
+
+#endif
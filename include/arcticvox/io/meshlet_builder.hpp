@@ -0,0 +1,53 @@
+#ifndef ARCTICVOX_MESHLET_BUILDER_HPP
+#define ARCTICVOX_MESHLET_BUILDER_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/vertex.hpp"
+
+namespace arcticvox::io {
+
+/**
+ * @class meshlet_builder
+ * @brief Partitions triangle lists into meshlets for cluster culling
+ */
+class meshlet_builder final {
+  public:
+    /**
+     * @brief Splits one mesh into meshlets and reorders its triangles to match
+     *
+     * @param indices The triangle list of the mesh, reordered in place
+     * @param vertices The vertices addressed by the indices
+     * @param max_vertices The largest number of unique vertices per meshlet
+     * @param max_triangles The largest number of triangles per meshlet
+     * @return The meshlets, first_index relative to the start of indices
+     *
+     * @details Meshlets are grown greedily from a seed triangle, always adding the neighbouring
+     * triangle that brings in the fewest new vertices and, among those, the one closest to the
+     * meshlet. A meshlet is closed once either limit would be exceeded or no neighbour is left, the
+     * next one is seeded with the first remaining triangle in the input order.
+     */
+    static std::vector<components::meshlet> build(
+        std::span<uint32_t> indices,
+        std::span<const components::vertex> vertices,
+        uint32_t max_vertices = components::meshlet::MAX_VERTICES,
+        uint32_t max_triangles = components::meshlet::MAX_TRIANGLES);
+
+    /**
+     * @brief Computes the bounding sphere and normal cone of a meshlet's triangles
+     *
+     * @param indices The triangle list of the meshlet
+     * @param vertices The vertices addressed by the indices
+     * @param output Receives the bounds, the index range is left untouched
+     */
+    static void compute_bounds(std::span<const uint32_t> indices,
+                               std::span<const components::vertex> vertices,
+                               components::meshlet& output);
+};
+
+}
+
+#endif
@@ -5,15 +5,78 @@
 #include <filesystem>
 #include <vector>
 
+#include "arcticvox/components/bounds.hpp"
+#include "arcticvox/components/compact_vertex.hpp"
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/submesh.hpp"
 #include "arcticvox/components/vertex.hpp"
 
+namespace arcticvox {
+class thread_pool;
+}
+
 namespace arcticvox::io {
 
 struct model_builder {
-    std::vector<components::vertex> vertices {};
-    std::vector<uint32_t> indices {};
+    std::vector<components::vertex> vertices {};      //!< Unique vertices of all meshes
+    std::vector<uint32_t> indices {};                 //!< Triangle lists relative to their submesh
+    std::vector<components::submesh> submeshes {};    //!< Draw ranges and node transforms
+    std::vector<components::meshlet> meshlets {};     //!< Clusters of all submeshes' full meshes
+    components::aabb bounds {};                       //!< Bounds of all vertex positions
+    //! Quantised vertices, replace vertices when vertex_format is compact
+    std::vector<components::compact_vertex> compact_vertices {};
 
+    bool use_mesh_cache = true;                       //!< Use io::mesh_cache for loading
+    bool optimise_meshes = false;                     //!< Run io::mesh_optimiser after importing
+    bool generate_lods = false;                       //!< Build simplified levels of detail
+    bool build_meshlets = false;                      //!< Partition meshes for cluster culling
+    thread_pool* workers = nullptr;                   //!< Pool for a parallel import, optional
+    //! Layout of the vertex buffer created from the builder
+    components::vertex_format vertex_format = components::vertex_format::full;
+
+    /**
+     * @brief Loads the model at the provided path into the builder
+     *
+     * @param filepath The model file to load, relative paths are resolved against the executable
+     * @return True if the model was loaded
+     *
+     * @details If use_mesh_cache is set, the content hash of the file is looked up in the mesh
+     * cache first. On a hit the importer is skipped entirely, on a miss the model is imported and
+     * the cache is written for the next load.
+     *
+     * If a worker pool is set, vertex conversion is split into chunks across meshes and welding
+     * runs per mesh on the pool, both writing straight into the pre-sized output arrays.
+     *
+     * Imported faces are triangulated and the vertices they reference are welded per mesh, i.e.
+     * bitwise identical vertices are stored once and referenced through the index buffer.
+     *
+     * Every mesh keeps its own contiguous vertex and index range. The scene's node hierarchy is
+     * flattened into one submesh per node and referenced mesh, carrying the accumulated node
+     * transform and the mesh's material index.
+     *
+     * If optimise_meshes is set, every welded mesh is reordered for vertex cache locality, low
+     * overdraw and sequential vertex fetches. Optimised and unoptimised imports are cached
+     * separately.
+     *
+     * If build_meshlets is set, io::meshlet_builder partitions every mesh into meshlets of up to
+     * 64 vertices and 124 triangles and reorders its triangles to match. The optimiser's vertex
+     * cache order is restored within every meshlet, its overdraw order is not kept.
+     *
+     * If generate_lods is set, io::mesh_simplifier reduces every mesh to 50%, 25% and 10% of its
+     * triangles. The levels are appended to indices and recorded with their error in the
+     * submeshes. Levels that barely reduce the previous one end the chain early.
+     *
+     * If vertex_format is compact, the loaded vertices are quantised with quantise_vertices().
+     */
     [[nodiscard]] bool load_model(const std::filesystem::path& filepath);
+
+    /**
+     * @brief Converts vertices into compact_vertices, relative to bounds
+     *
+     * @details vertices is cleared afterwards, the quantised positions are mapped back into model
+     * space with components::compact_vertex::dequantisation_matrix(bounds).
+     */
+    void quantise_vertices();
 };
 }
 
@@ -0,0 +1,95 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+// graphics::gpu_culler::candidate, one submesh of one object
+struct candidate {
+    vec4 sphere;           // bounding sphere in the space of the vertices, radius in w
+    vec4 inverse_scale;    // undoes the scale of the vertex transform per axis
+    uint index_count;      // vertex count for models without indices
+    uint first_index;
+    int vertex_offset;     // first vertex for models without indices
+    uint first_instance;
+    uint batch;
+    uint first_command;    // of the batch
+    uint indexed;
+    uint padding;
+};
+
+// components::instance, the model matrix includes the vertex transform
+struct instance {
+    mat4 model_matrix;
+    vec4 colour;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer candidate_buffer {
+    candidate candidates[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer instance_buffer {
+    instance instances[];
+};
+
+// vk::DrawIndexedIndirectCommand, or vk::DrawIndirectCommand padded to the same stride
+layout(std430, set = 0, binding = 2) writeonly buffer command_buffer {
+    uint commands[];
+};
+
+// one draw count per batch
+layout(std430, set = 0, binding = 3) buffer count_buffer {
+    uint counts[];
+};
+
+// per candidate, VISIBLE if it passed the last occlusion test and DRAWN if drawn before it
+layout(std430, set = 0, binding = 4) buffer visibility_buffer {
+    uint visibility[];
+};
+
+layout(push_constant) uniform push_data {
+    vec4 planes[6];    // world space frustum, normals point inwards
+    uint candidate_count;
+    uint occlusion;    // only draw what was visible, the occlusion pass draws the rest
+}
+push;
+
+const uint VISIBLE = 1u;
+const uint DRAWN = 2u;
+
+const uint COMMAND_STRIDE = 5;
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if(id >= push.candidate_count)
+        return;
+
+    candidate c = candidates[id];
+    mat4 model = instances[c.first_instance].model_matrix;
+    vec3 center = (model * vec4(c.sphere.xyz, 1.0)).xyz;
+    // the largest scale of the object and submesh transform, without the vertex transform
+    float scale = max(max(length(model[0].xyz) * c.inverse_scale.x,
+                          length(model[1].xyz) * c.inverse_scale.y),
+                      length(model[2].xyz) * c.inverse_scale.z);
+    float radius = c.sphere.w * scale;
+    for(int i = 0; i < 6; ++i) {
+        if(dot(push.planes[i].xyz, center) + push.planes[i].w < -radius)
+            return;
+    }
+    if(push.occlusion != 0u) {
+        if((visibility[id] & VISIBLE) == 0u)
+            return;
+        visibility[id] = VISIBLE | DRAWN;
+    }
+
+    // visible candidates of a batch are compacted to the front of its commands
+    uint command = (c.first_command + atomicAdd(counts[c.batch], 1u)) * COMMAND_STRIDE;
+    commands[command] = c.index_count;
+    commands[command + 1] = 1u;
+    if(c.indexed != 0u) {
+        commands[command + 2] = c.first_index;
+        commands[command + 3] = uint(c.vertex_offset);
+        commands[command + 4] = c.first_instance;
+    } else {
+        commands[command + 2] = uint(c.vertex_offset);
+        commands[command + 3] = c.first_instance;
+    }
+}
@@ -0,0 +1,29 @@
+#version 450
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// the depth attachment for the first level, the previous level otherwise
+layout(set = 0, binding = 0) uniform sampler2D source;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D destination;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 destination_size = imageSize(destination);
+    if(any(greaterThanEqual(texel, destination_size)))
+        return;
+
+    // each texel covers two source texels per axis, the last one also covers a third of an odd
+    // source, so that the pyramid stays conservative at every size
+    ivec2 source_size = textureSize(source, 0);
+    ivec2 first = texel * 2;
+    ivec2 last = first + 1 + ivec2(equal(texel, destination_size - 1)) * (source_size & 1);
+    last = min(last, source_size - 1);
+
+    // the farthest depth of the area, anything behind it is hidden
+    float depth = 0.0;
+    for(int y = first.y; y <= last.y; ++y) {
+        for(int x = first.x; x <= last.x; ++x)
+            depth = max(depth, texelFetch(source, ivec2(x, y), 0).r);
+    }
+    imageStore(destination, texel, vec4(depth));
+}
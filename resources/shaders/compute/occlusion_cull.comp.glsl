@@ -0,0 +1,140 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+// graphics::gpu_culler::candidate, one submesh of one object
+struct candidate {
+    vec4 sphere;           // bounding sphere in the space of the vertices, radius in w
+    vec4 inverse_scale;    // undoes the scale of the vertex transform per axis
+    uint index_count;      // vertex count for models without indices
+    uint first_index;
+    int vertex_offset;     // first vertex for models without indices
+    uint first_instance;
+    uint batch;
+    uint first_command;    // of the batch
+    uint indexed;
+    uint padding;
+};
+
+// components::instance, the model matrix includes the vertex transform
+struct instance {
+    mat4 model_matrix;
+    vec4 colour;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer candidate_buffer {
+    candidate candidates[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer instance_buffer {
+    instance instances[];
+};
+
+// vk::DrawIndexedIndirectCommand, or vk::DrawIndirectCommand padded to the same stride, the
+// commands of this pass follow those of the culling pass
+layout(std430, set = 0, binding = 2) writeonly buffer command_buffer {
+    uint commands[];
+};
+
+// one draw count per batch and pass
+layout(std430, set = 0, binding = 3) buffer count_buffer {
+    uint counts[];
+};
+
+// per candidate, VISIBLE if it passed the last occlusion test and DRAWN if drawn before it
+layout(std430, set = 0, binding = 4) buffer visibility_buffer {
+    uint visibility[];
+};
+
+// the farthest depth of the frame's opaque geometry, level 0 at half the depth's resolution
+layout(set = 1, binding = 0) uniform sampler2D depth_pyramid;
+
+layout(push_constant) uniform push_data {
+    mat4 projection_view;
+    uvec2 depth_size;    // of the depth attachment the pyramid was built from
+    uint candidate_count;
+    uint batch_count;
+    uint level_count;
+}
+push;
+
+const uint VISIBLE = 1u;
+const uint DRAWN = 2u;
+const uint COMMAND_STRIDE = 5;
+
+// whether the world space box lies outside of the frustum or behind the depth pyramid
+bool hidden(vec3 box_min, vec3 box_max) {
+    vec2 ndc_min = vec2(1.0);
+    vec2 ndc_max = vec2(-1.0);
+    float nearest = 1.0;
+    for(int corner = 0; corner < 8; ++corner) {
+        vec3 position = mix(box_min, box_max, vec3(corner & 1, (corner >> 1) & 1, corner >> 2));
+        vec4 clip = push.projection_view * vec4(position, 1.0);
+        // boxes reaching behind the camera are never hidden
+        if(clip.w <= 0.0)
+            return false;
+        vec3 ndc = clip.xyz / clip.w;
+        ndc_min = min(ndc_min, ndc.xy);
+        ndc_max = max(ndc_max, ndc.xy);
+        nearest = min(nearest, ndc.z);
+    }
+    if(any(lessThan(ndc_max, vec2(-1.0))) || any(greaterThan(ndc_min, vec2(1.0)))
+       || (nearest > 1.0))
+        return true;
+
+    // the depth pixels the box covers, the level where they span at most two texels per axis
+    vec2 uv_min = clamp(ndc_min * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uv_max = clamp(ndc_max * 0.5 + 0.5, 0.0, 1.0);
+    ivec2 pixel_max = ivec2(push.depth_size) - 1;
+    ivec2 first = min(ivec2(uv_min * vec2(push.depth_size)), pixel_max);
+    ivec2 last = min(ivec2(uv_max * vec2(push.depth_size)), pixel_max);
+    int span = max(last.x - first.x, last.y - first.y) + 1;
+    int level = clamp(findMSB(max(span - 1, 1)), 0, int(push.level_count) - 1);
+
+    // a level's texel covers 2^(level + 1) pixels per axis, its last texel also the remainder
+    ivec2 level_last = textureSize(depth_pyramid, level) - 1;
+    ivec2 texel_first = min(first >> (level + 1), level_last);
+    ivec2 texel_last = min(last >> (level + 1), level_last);
+    float farthest = 0.0;
+    for(int y = texel_first.y; y <= texel_last.y; ++y) {
+        for(int x = texel_first.x; x <= texel_last.x; ++x)
+            farthest = max(farthest, texelFetch(depth_pyramid, ivec2(x, y), level).r);
+    }
+    return nearest > farthest;
+}
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if(id >= push.candidate_count)
+        return;
+
+    candidate c = candidates[id];
+    mat4 model = instances[c.first_instance].model_matrix;
+    vec3 center = (model * vec4(c.sphere.xyz, 1.0)).xyz;
+    // the largest scale of the object and submesh transform, without the vertex transform
+    float scale = max(max(length(model[0].xyz) * c.inverse_scale.x,
+                          length(model[1].xyz) * c.inverse_scale.y),
+                      length(model[2].xyz) * c.inverse_scale.z);
+    float radius = c.sphere.w * scale;
+
+    // submeshes without bounds are always visible
+    bool visible = isinf(radius) || isnan(radius) || !hidden(center - radius, center + radius);
+    bool drawn = (visibility[id] & DRAWN) != 0u;
+    visibility[id] = visible ? VISIBLE : 0u;
+    if(!visible || drawn)
+        return;
+
+    // newly visible candidates of a batch are compacted to the front of its commands
+    uint slot = c.first_command + atomicAdd(counts[push.batch_count + c.batch], 1u);
+    uint command = (push.candidate_count + slot) * COMMAND_STRIDE;
+    commands[command] = c.index_count;
+    commands[command + 1] = 1u;
+    if(c.indexed != 0u) {
+        commands[command + 2] = c.first_index;
+        commands[command + 3] = uint(c.vertex_offset);
+        commands[command + 4] = c.first_instance;
+    } else {
+        commands[command + 2] = uint(c.vertex_offset);
+        commands[command + 3] = c.first_instance;
+    }
+}
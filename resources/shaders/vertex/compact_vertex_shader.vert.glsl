@@ -0,0 +1,39 @@
+#version 450
+
+// components::compact_vertex, the formats of the attributes convert to floats on fetch
+layout(location = 0) in vec4 position;    // unorm, relative to the model bounds
+layout(location = 1) in vec4 colour;      // unorm
+layout(location = 2) in vec2 normal;      // snorm, octahedral encoded
+layout(location = 3) in vec2 uv;          // half float
+
+// components::instance, the model matrix includes the dequantisation from the unit cube into the
+// model bounds
+layout(location = 4) in mat4 instance_model;
+layout(location = 8) in vec4 instance_colour;
+
+layout(location = 0) out vec3 frag_colour;
+layout(location = 1) out vec3 frag_normal;
+layout(location = 2) out vec2 frag_uv;
+
+// components::camera_uniform_data, bound once per frame
+layout(set = 0, binding = 0) uniform camera_data {
+    mat4 view;
+    mat4 projection;
+    mat4 projection_view;
+}
+camera;
+
+vec3 decode_octahedral(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    // unfold the lower hemisphere
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main() {
+    gl_Position = camera.projection_view * instance_model * vec4(position.xyz, 1.0);
+    frag_colour = colour.rgb;
+    frag_normal = decode_octahedral(normal);
+    frag_uv = uv;
+}
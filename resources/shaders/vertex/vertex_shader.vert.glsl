@@ -3,19 +3,25 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 colour;
 
+// components::instance, the model matrix includes the submesh node transform
+layout(location = 4) in mat4 instance_model;
+layout(location = 8) in vec4 instance_colour;
+
 layout(location = 0) out vec3 frag_colour;
 
-layout(push_constant) uniform push_data {
-    mat4 transform;
-    vec3 colour;
+// components::camera_uniform_data, bound once per frame
+layout(set = 0, binding = 0) uniform camera_data {
+    mat4 view;
+    mat4 projection;
+    mat4 projection_view;
 }
-push;
+camera;
 
 void main() {
     // gl_VertexIndex: To index into the array, contains the current vertex for
     // each vertex the main function is run
     // z = 0.0 it's at the front
     // alpha = whole vector is divided by it
-    gl_Position = push.transform * vec4(position, 1.0);
+    gl_Position = camera.projection_view * instance_model * vec4(position, 1.0);
     frag_colour = colour;
 }
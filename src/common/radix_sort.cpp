@@ -0,0 +1,53 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "arcticvox/common/radix_sort.hpp"
+
+namespace arcticvox {
+
+namespace {
+constexpr std::size_t RADIX_BITS = 8U;
+constexpr std::size_t BUCKET_COUNT = std::size_t {1U} << RADIX_BITS;
+constexpr std::size_t PASS_COUNT = 64U / RADIX_BITS;
+}
+
+void radix_sorter::sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values) {
+    if(keys.size() != values.size())
+        throw std::runtime_error("Radix sort needs exactly one value per key");
+
+    // the histograms of all passes are counted in a single read of the keys
+    std::array<std::array<std::size_t, BUCKET_COUNT>, PASS_COUNT> histograms {};
+    for(const uint64_t key: keys) {
+        for(std::size_t pass = 0U; pass < PASS_COUNT; ++pass)
+            ++histograms[pass][(key >> (pass * RADIX_BITS)) & (BUCKET_COUNT - 1U)];
+    }
+
+    key_scratch_.resize(keys.size());
+    value_scratch_.resize(values.size());
+    for(std::size_t pass = 0U; pass < PASS_COUNT; ++pass) {
+        std::array<std::size_t, BUCKET_COUNT>& offsets = histograms[pass];
+        const std::size_t shift = pass * RADIX_BITS;
+        // all keys share the byte, the pass would not move anything
+        if(keys.empty() || (offsets[(keys.front() >> shift) & (BUCKET_COUNT - 1U)] == keys.size()))
+            continue;
+
+        std::size_t offset = 0U;
+        for(std::size_t& bucket: offsets) {
+            const std::size_t count = bucket;
+            bucket = offset;
+            offset += count;
+        }
+        for(std::size_t i = 0U; i < keys.size(); ++i) {
+            const std::size_t destination = offsets[(keys[i] >> shift) & (BUCKET_COUNT - 1U)]++;
+            key_scratch_[destination] = keys[i];
+            value_scratch_[destination] = values[i];
+        }
+        keys.swap(key_scratch_);
+        values.swap(value_scratch_);
+    }
+}
+
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arcticvox/common/thread_pool.hpp"
+
+namespace arcticvox {
+
+thread_pool::thread_pool(std::size_t thread_count) {
+    if(thread_count == 0U)
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+
+    workers_.reserve(thread_count);
+    for(std::size_t i = 0U; i < thread_count; ++i)
+        workers_.emplace_back([this]() { worker_loop(); });
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard lock {mutex_};
+        stopping_ = true;
+    }
+    task_available_.notify_all();
+    for(std::thread& worker: workers_)
+        worker.join();
+}
+
+void thread_pool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock {mutex_};
+        tasks_.push_back(std::move(task));
+    }
+    task_available_.notify_one();
+    // waiting threads execute queued tasks as well
+    task_changed_.notify_all();
+}
+
+void thread_pool::finish_task() {
+    // the task completed its future before, locking orders that before a waiter's check
+    {
+        std::lock_guard lock {mutex_};
+    }
+    task_changed_.notify_all();
+}
+
+void thread_pool::parallel_for(const std::size_t count,
+                               const std::function<void(std::size_t)>& fn) {
+    if(count == 0U)
+        return;
+
+    std::atomic<std::size_t> next_index {0U};
+    const auto process = [&]() {
+        for(std::size_t i = next_index++; i < count; i = next_index++)
+            fn(i);
+    };
+
+    // the calling thread takes part as well, so one helper less is needed
+    const std::size_t helper_count = std::min(workers_.size(), count - 1U);
+    std::vector<std::future<void>> helpers;
+    helpers.reserve(helper_count);
+    for(std::size_t i = 0U; i < helper_count; ++i)
+        helpers.push_back(submit(process));
+
+    std::exception_ptr error;
+    try {
+        process();
+    } catch(...) {
+        error = std::current_exception();
+        // make the helpers run out of work
+        next_index = count;
+    }
+
+    // the helpers reference the local state, all of them have to finish before returning
+    for(std::future<void>& helper: helpers) {
+        wait(helper);
+        try {
+            helper.get();
+        } catch(...) {
+            if(!error)
+                error = std::current_exception();
+        }
+    }
+
+    if(error)
+        std::rethrow_exception(error);
+}
+
+bool thread_pool::run_pending_task() {
+    std::function<void()> task;
+    {
+        std::lock_guard lock {mutex_};
+        if(tasks_.empty())
+            return false;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+    }
+    task();
+    finish_task();
+    return true;
+}
+
+void thread_pool::worker_loop() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock {mutex_};
+            task_available_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if(tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+        finish_task();
+    }
+}
+
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "arcticvox/components/bounds.hpp"
+#include "arcticvox/components/compact_vertex.hpp"
+#include "arcticvox/components/vertex.hpp"
+
+namespace arcticvox::components {
+
+namespace {
+uint16_t quantise_unorm16(const float value) {
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+int16_t quantise_snorm16(const float value) {
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+uint8_t quantise_unorm8(const float value) {
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+/**
+ * @brief Maps a unit vector onto the octahedron and unfolds it into [-1, 1]^2
+ */
+glm::vec2 encode_octahedral(const glm::vec3& normal) {
+    const float l1_norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if(l1_norm == 0.0f)
+        return glm::vec2 {0.0f, 0.0f};
+
+    const glm::vec3 n = normal / l1_norm;
+    if(n.z >= 0.0f)
+        return glm::vec2 {n.x, n.y};
+
+    // fold the lower hemisphere over the diagonals
+    return glm::vec2 {(1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)};
+}
+}
+
+auto compact_vertex::get_binding_description() -> std::vector<vk::VertexInputBindingDescription> {
+    return std::vector<vk::VertexInputBindingDescription> {{.binding = 0U,
+                                                             .stride = sizeof(compact_vertex),
+                                                             .inputRate =
+                                                                 vk::VertexInputRate::eVertex}};
+}
+
+auto compact_vertex::get_attribute_description()
+    -> std::vector<vk::VertexInputAttributeDescription> {
+    return std::vector<vk::VertexInputAttributeDescription> {
+        {.location = 0U,
+         .binding = 0U,
+         .format = vk::Format::eR16G16B16A16Unorm,
+         .offset = offsetof(compact_vertex, position)},
+        {.location = 1U,
+         .binding = 0U,
+         .format = vk::Format::eR8G8B8A8Unorm,
+         .offset = offsetof(compact_vertex, colour)},
+        {.location = 2U,
+         .binding = 0U,
+         .format = vk::Format::eR16G16Snorm,
+         .offset = offsetof(compact_vertex, normal)},
+        {.location = 3U,
+         .binding = 0U,
+         .format = vk::Format::eR16G16Sfloat,
+         .offset = offsetof(compact_vertex, uv)},
+    };
+}
+
+auto compact_vertex::quantise(const vertex& vtx, const aabb& bounds) -> compact_vertex {
+    const glm::vec3 extent = bounds.extent();
+    const auto relative = [&](const int axis) {
+        return (extent[axis] > 0.0f) ? (vtx.position.pos[axis] - bounds.min[axis]) / extent[axis]
+                                     : 0.0f;
+    };
+    const glm::vec2 normal = encode_octahedral(vtx.normal);
+
+    return compact_vertex {
+        .position = {quantise_unorm16(relative(0)),
+                     quantise_unorm16(relative(1)),
+                     quantise_unorm16(relative(2)),
+                     0U},
+        .colour = {quantise_unorm8(vtx.colour.col.x),
+                   quantise_unorm8(vtx.colour.col.y),
+                   quantise_unorm8(vtx.colour.col.z),
+                   quantise_unorm8(vtx.colour.col.w)},
+        .normal = {quantise_snorm16(normal.x), quantise_snorm16(normal.y)},
+        .uv = {glm::packHalf1x16(vtx.uv.uv.x), glm::packHalf1x16(vtx.uv.uv.y)}};
+}
+
+auto compact_vertex::dequantisation_matrix(const aabb& bounds) -> glm::mat4 {
+    return glm::scale(glm::translate(glm::mat4 {1.0f}, bounds.min), bounds.extent());
+}
+
+}
@@ -0,0 +1,37 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <glm/vec4.hpp>
+
+#include "arcticvox/components/instance.hpp"
+
+namespace arcticvox::components {
+
+auto instance::get_binding_description() -> std::vector<vk::VertexInputBindingDescription> {
+    return std::vector<vk::VertexInputBindingDescription> {{.binding = BINDING,
+                                                             .stride = sizeof(instance),
+                                                             .inputRate =
+                                                                 vk::VertexInputRate::eInstance}};
+}
+
+auto instance::get_attribute_description() -> std::vector<vk::VertexInputAttributeDescription> {
+    std::vector<vk::VertexInputAttributeDescription> attributes {};
+    // a matrix attribute takes one location per column
+    for(uint32_t column = 0U; column < 4U; ++column)
+        attributes.push_back(
+            {.location = FIRST_LOCATION + column,
+             .binding = BINDING,
+             .format = vk::Format::eR32G32B32A32Sfloat,
+             .offset = static_cast<uint32_t>(offsetof(instance, model_matrix)
+                                             + column * sizeof(glm::vec4))});
+    attributes.push_back({.location = FIRST_LOCATION + 4U,
+                          .binding = BINDING,
+                          .format = vk::Format::eR32G32B32A32Sfloat,
+                          .offset = offsetof(instance, colour)});
+    return attributes;
+}
+
+}
@@ -1,5 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
 #include <vulkan/vulkan_raii.hpp>
 
+#include "arcticvox/components/compact_vertex.hpp"
 #include "arcticvox/components/model.hpp"
 #include "arcticvox/components/vertex.hpp"
 #include "arcticvox/graphics/driver.hpp"
@@ -9,75 +17,180 @@ namespace arcticvox::components {
 
 model::model(graphics::gpu_driver& driver, const io::model_builder& vertices) :
     driver_(driver),
-    vertex_count_(vertices.vertices.size()),
-    vertex_buffer_(nullptr),
-    vertex_buffer_memory_(nullptr),
+    format_(vertices.vertex_format),
+    vertex_transform_((format_ == vertex_format::compact)
+                          ? compact_vertex::dequantisation_matrix(vertices.bounds)
+                          : glm::mat4 {1.0f}),
+    vertex_count_((format_ == vertex_format::compact) ? vertices.compact_vertices.size()
+                                                      : vertices.vertices.size()),
     indices_count_(vertices.indices.size()),
-    indices_buffer_(nullptr),
-    indices_buffer_memory_(nullptr),
+    submeshes_(vertices.submeshes),
+    meshlets_(vertices.meshlets),
     has_index_buffer(vertices.indices.size() > 0U) {
-    create_vertex_buffers(vertices.vertices);
-    create_index_buffers(vertices.indices);
+    if(submeshes_.empty())
+        submeshes_.push_back(submesh {.first_index = 0U,
+                                      .index_count = static_cast<uint32_t>(indices_count_),
+                                      .vertex_offset = 0,
+                                      .material_id = 0U,
+                                      .bounds = vertices.bounds,
+                                      .transform = glm::mat4 {1.0f}});
+    upload_geometry(vertices);
 }
-void model::create_vertex_buffers(const std::vector<vertex>& vertices) {
-    if(vertices.size() < 3U)
-        throw std::runtime_error("Vertex count must be at least 3");
 
-    const std::size_t buffer_sz = sizeof(vertices.front()) * vertices.size();
-    vk::raii::Buffer staging_buffer =
-        driver_.create_buffer(buffer_sz, vk::BufferUsageFlagBits::eTransferSrc);
-    vk::raii::DeviceMemory staging_buffer_memory = driver_.bind_memory_to_buffer(
-        staging_buffer,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-    // copy data to shared memory
-    void* data =
-        staging_buffer_memory.mapMemory(0U, buffer_sz, static_cast<vk::MemoryMapFlags>(0U));
-    std::memcpy(data, vertices.data(), static_cast<std::size_t>(buffer_sz));
-    staging_buffer_memory.unmapMemory();
-
-    vertex_buffer_ = driver_.create_buffer(
-        buffer_sz, vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
-    vertex_buffer_memory_ =
-        driver_.bind_memory_to_buffer(vertex_buffer_, vk::MemoryPropertyFlagBits::eDeviceLocal);
-    driver_.copy_buffer(staging_buffer, vertex_buffer_, buffer_sz);
+void model::evict() {
+    residency expected = residency::resident;
+    if(!residency_.compare_exchange_strong(expected, residency::evicted, std::memory_order_acq_rel))
+        return;
+    geometry_.reset();
 }
 
-void model::create_index_buffers(const std::vector<uint32_t>& indices) {
-    if(indices.empty())
-        return;
+bool model::begin_restore() {
+    residency expected = residency::evicted;
+    return residency_.compare_exchange_strong(
+        expected, residency::restoring, std::memory_order_acq_rel);
+}
 
-    const std::size_t buffer_sz = sizeof(indices.front()) * indices.size();
-    vk::raii::Buffer staging_buffer =
-        driver_.create_buffer(buffer_sz, vk::BufferUsageFlagBits::eTransferSrc);
-    vk::raii::DeviceMemory staging_buffer_memory = driver_.bind_memory_to_buffer(
-        staging_buffer,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-    // copy data to shared memory
-    void* data =
-        staging_buffer_memory.mapMemory(0U, buffer_sz, static_cast<vk::MemoryMapFlags>(0U));
-    std::memcpy(data, indices.data(), static_cast<std::size_t>(buffer_sz));
-    staging_buffer_memory.unmapMemory();
-
-    indices_buffer_ = driver_.create_buffer(
-        buffer_sz, vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
-    indices_buffer_memory_ =
-        driver_.bind_memory_to_buffer(indices_buffer_, vk::MemoryPropertyFlagBits::eDeviceLocal);
-    driver_.copy_buffer(staging_buffer, indices_buffer_, buffer_sz);
+void model::restore(const io::model_builder& builder) {
+    const std::size_t vertex_count = (format_ == vertex_format::compact)
+                                         ? builder.compact_vertices.size()
+                                         : builder.vertices.size();
+    try {
+        if((builder.vertex_format != format_) || (vertex_count != vertex_count_)
+           || (builder.indices.size() != indices_count_))
+            throw std::runtime_error("Reimported model does not match the evicted one");
+        upload_geometry(builder);
+    } catch(...) {
+        geometry_.reset();
+        residency_.store(residency::evicted, std::memory_order_release);
+        throw;
+    }
+    // publishes the new ranges to the render thread
+    residency_.store(residency::resident, std::memory_order_release);
 }
 
-void model::draw(vk::raii::CommandBuffer& command_buffer) {
+void model::upload_geometry(const io::model_builder& builder) {
+    if(vertex_count_ < 3U)
+        throw std::runtime_error("Vertex count must be at least 3");
+
+    std::size_t vertex_stride = sizeof(vertex);
+    const void* vertex_data = builder.vertices.data();
+    if(format_ == vertex_format::compact) {
+        vertex_stride = sizeof(compact_vertex);
+        vertex_data = builder.compact_vertices.data();
+    }
+
+    // halves the index memory and bandwidth, indices are relative to their submesh, so this
+    // applies to all models whose meshes have less than 64k vertices each
+    std::vector<uint16_t> short_indices;
+    if(has_index_buffer
+       && (*std::max_element(builder.indices.cbegin(), builder.indices.cend())
+           <= std::numeric_limits<uint16_t>::max())) {
+        short_indices.assign(builder.indices.cbegin(), builder.indices.cend());
+        index_type_ = vk::IndexType::eUint16;
+    }
+    std::size_t index_stride = sizeof(uint32_t);
+    const void* index_data = builder.indices.data();
+    if(index_type_ == vk::IndexType::eUint16) {
+        index_stride = sizeof(uint16_t);
+        index_data = short_indices.data();
+    }
+
+    graphics::geometry_arena& arena = driver_.geometry();
+    geometry_ = arena.allocate(
+        vertex_stride * vertex_count_, vertex_stride, index_stride * indices_count_, index_stride);
+
+    std::vector<graphics::buffer_upload> uploads {
+        graphics::buffer_upload {.destination = *arena.vertex_buffer(),
+                                 .data = vertex_data,
+                                 .size = vertex_stride * vertex_count_,
+                                 .destination_offset = geometry_.vertex_offset(),
+                                 .mapped_destination = arena.vertex_data()}};
     if(has_index_buffer)
-        command_buffer.drawIndexed(indices_count_, 1U, 0U, 0U, 0U);
-    else
-        command_buffer.draw(vertex_count_, 1U, 0U, 0U);
+        uploads.push_back(graphics::buffer_upload {.destination = *arena.index_buffer(),
+                                                   .data = index_data,
+                                                   .size = index_stride * indices_count_,
+                                                   .destination_offset = geometry_.index_offset(),
+                                                   .mapped_destination = arena.index_data()});
+    // both copies go out in a single submission, the model is usable once it has finished, a host
+    // visible arena is written in place and needs no wait
+    driver_.wait_for_upload(driver_.upload_buffers(uploads));
+    geometry_.mark_uploaded();
 }
 
-void model::bind(vk::raii::CommandBuffer& command_buffer) {
-    command_buffer.bindVertexBuffers(0U, {vertex_buffer_}, {0U});
+void model::draw(vk::raii::CommandBuffer& command_buffer,
+                 const std::size_t submesh_index,
+                 const std::size_t level,
+                 const uint32_t instance_count,
+                 const uint32_t first_instance) {
+    const vk::DrawIndexedIndirectCommand command =
+        draw_command(submesh_index, level, instance_count, first_instance);
     if(has_index_buffer)
-        command_buffer.bindIndexBuffer(indices_buffer_, 0U, vk::IndexType::eUint32);
+        command_buffer.drawIndexed(command.indexCount,
+                                   command.instanceCount,
+                                   command.firstIndex,
+                                   command.vertexOffset,
+                                   command.firstInstance);
+    else
+        command_buffer.draw(command.indexCount,
+                            command.instanceCount,
+                            static_cast<uint32_t>(command.vertexOffset),
+                            command.firstInstance);
+}
+
+void model::draw_meshlets(vk::raii::CommandBuffer& command_buffer,
+                          const std::size_t submesh_index,
+                          const std::size_t first_meshlet,
+                          const std::size_t meshlet_count,
+                          const uint32_t first_instance) {
+    const vk::DrawIndexedIndirectCommand command =
+        meshlet_draw_command(submesh_index, first_meshlet, meshlet_count, first_instance);
+    if(command.indexCount == 0U)
+        return;
+    command_buffer.drawIndexed(command.indexCount,
+                               command.instanceCount,
+                               command.firstIndex,
+                               command.vertexOffset,
+                               command.firstInstance);
+}
+
+vk::DrawIndexedIndirectCommand model::draw_command(const std::size_t submesh_index,
+                                                   const std::size_t level,
+                                                   const uint32_t instance_count,
+                                                   const uint32_t first_instance) const {
+    if(!has_index_buffer)
+        return vk::DrawIndexedIndirectCommand {
+            .indexCount = static_cast<uint32_t>(vertex_count_),
+            .instanceCount = instance_count,
+            .firstIndex = 0U,
+            .vertexOffset = geometry_.first_vertex(),
+            .firstInstance = first_instance};
+
+    const submesh& mesh = submeshes_.at(submesh_index);
+    const submesh_lod range = mesh.lod(std::min(level, mesh.level_count() - 1U));
+    return vk::DrawIndexedIndirectCommand {
+        .indexCount = range.index_count,
+        .instanceCount = instance_count,
+        .firstIndex = geometry_.first_index() + range.first_index,
+        .vertexOffset = geometry_.first_vertex() + mesh.vertex_offset,
+        .firstInstance = first_instance};
+}
+
+vk::DrawIndexedIndirectCommand model::meshlet_draw_command(const std::size_t submesh_index,
+                                                           const std::size_t first_meshlet,
+                                                           const std::size_t meshlet_count,
+                                                           const uint32_t first_instance) const {
+    const submesh& mesh = submeshes_.at(submesh_index);
+    if((meshlet_count == 0U) || (first_meshlet + meshlet_count > mesh.meshlet_count))
+        return vk::DrawIndexedIndirectCommand {};
+
+    const meshlet& first = meshlets_.at(mesh.first_meshlet + first_meshlet);
+    const meshlet& last = meshlets_.at(mesh.first_meshlet + first_meshlet + meshlet_count - 1U);
+    return vk::DrawIndexedIndirectCommand {
+        .indexCount = last.first_index + last.index_count - first.first_index,
+        .instanceCount = 1U,
+        .firstIndex = geometry_.first_index() + first.first_index,
+        .vertexOffset = geometry_.first_vertex() + mesh.vertex_offset,
+        .firstInstance = first_instance};
 }
 
 }
@@ -0,0 +1,214 @@
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "arcticvox/components/transform.hpp"
+#include "arcticvox/components/transform_store.hpp"
+
+namespace arcticvox::components {
+
+namespace {
+#if defined(__AVX__)
+constexpr std::size_t WIDTH = 8U;
+using wide_float = __m256;
+
+wide_float load(const float* values) {
+    return _mm256_loadu_ps(values);
+}
+
+wide_float broadcast(const float value) {
+    return _mm256_set1_ps(value);
+}
+
+wide_float add(const wide_float a, const wide_float b) {
+    return _mm256_add_ps(a, b);
+}
+
+wide_float sub(const wide_float a, const wide_float b) {
+    return _mm256_sub_ps(a, b);
+}
+
+wide_float mul(const wide_float a, const wide_float b) {
+    return _mm256_mul_ps(a, b);
+}
+
+void store(float* values, const wide_float v) {
+    _mm256_storeu_ps(values, v);
+}
+#elif defined(__SSE2__)
+constexpr std::size_t WIDTH = 4U;
+using wide_float = __m128;
+
+wide_float load(const float* values) {
+    return _mm_loadu_ps(values);
+}
+
+wide_float broadcast(const float value) {
+    return _mm_set1_ps(value);
+}
+
+wide_float add(const wide_float a, const wide_float b) {
+    return _mm_add_ps(a, b);
+}
+
+wide_float sub(const wide_float a, const wide_float b) {
+    return _mm_sub_ps(a, b);
+}
+
+wide_float mul(const wide_float a, const wide_float b) {
+    return _mm_mul_ps(a, b);
+}
+
+void store(float* values, const wide_float v) {
+    _mm_storeu_ps(values, v);
+}
+#else
+constexpr std::size_t WIDTH = 1U;
+#endif
+}
+
+auto transform_store::create(const transform& initial) -> handle {
+    const auto id = static_cast<handle>(size());
+    translation_x_.push_back(initial.translation.x);
+    translation_y_.push_back(initial.translation.y);
+    translation_z_.push_back(initial.translation.z);
+    rotation_x_.push_back(initial.rotation.x);
+    rotation_y_.push_back(initial.rotation.y);
+    rotation_z_.push_back(initial.rotation.z);
+    rotation_w_.push_back(initial.rotation.w);
+    scale_x_.push_back(initial.scale.x);
+    scale_y_.push_back(initial.scale.y);
+    scale_z_.push_back(initial.scale.z);
+    world_.emplace_back(1.0f);
+    if(dirty_.size() * WORD_BITS < size())
+        dirty_.push_back(0U);
+    mark_dirty(id);
+    return id;
+}
+
+auto transform_store::get(const handle id) const -> transform {
+    return transform {
+        .rotation = glm::quat {rotation_w_[id], rotation_x_[id], rotation_y_[id], rotation_z_[id]},
+        .scale = glm::vec3 {scale_x_[id], scale_y_[id], scale_z_[id]},
+        .translation = glm::vec3 {translation_x_[id], translation_y_[id], translation_z_[id]}};
+}
+
+void transform_store::set(const handle id, const transform& value) {
+    set_translation(id, value.translation);
+    set_rotation(id, value.rotation);
+    set_scale(id, value.scale);
+}
+
+void transform_store::set_translation(const handle id, const glm::vec3& translation) {
+    translation_x_[id] = translation.x;
+    translation_y_[id] = translation.y;
+    translation_z_[id] = translation.z;
+    mark_dirty(id);
+}
+
+void transform_store::set_rotation(const handle id, const glm::quat& rotation) {
+    rotation_x_[id] = rotation.x;
+    rotation_y_[id] = rotation.y;
+    rotation_z_[id] = rotation.z;
+    rotation_w_[id] = rotation.w;
+    mark_dirty(id);
+}
+
+void transform_store::set_scale(const handle id, const glm::vec3& scale) {
+    scale_x_[id] = scale.x;
+    scale_y_[id] = scale.y;
+    scale_z_[id] = scale.z;
+    mark_dirty(id);
+}
+
+void transform_store::update() {
+    for(std::size_t word = 0U; word < dirty_.size(); ++word) {
+        uint64_t bits = std::exchange(dirty_[word], 0U);
+        // the groups of WIDTH transforms holding dirty ones are composed at once, groups never
+        // straddle a word
+        while(bits != 0U) {
+            const std::size_t offset =
+                static_cast<std::size_t>(std::countr_zero(bits)) & ~(WIDTH - 1U);
+            const uint64_t lanes = (bits >> offset) & ((uint64_t {1U} << WIDTH) - 1U);
+            const std::size_t first = word * WORD_BITS + offset;
+            if((WIDTH > 1U) && (first + WIDTH <= size()))
+                compose_wide(first, lanes);
+            else
+                compose_scalar(first, lanes);
+            bits &= ~(lanes << offset);
+        }
+    }
+}
+
+void transform_store::mark_dirty(const handle id) {
+    dirty_[id / WORD_BITS] |= uint64_t {1U} << (id % WORD_BITS);
+}
+
+void transform_store::compose_wide(const std::size_t first, const uint64_t lanes) {
+#if defined(__AVX__) || defined(__SSE2__)
+    const wide_float x = load(rotation_x_.data() + first);
+    const wide_float y = load(rotation_y_.data() + first);
+    const wide_float z = load(rotation_z_.data() + first);
+    const wide_float w = load(rotation_w_.data() + first);
+    const wide_float scale_x = load(scale_x_.data() + first);
+    const wide_float scale_y = load(scale_y_.data() + first);
+    const wide_float scale_z = load(scale_z_.data() + first);
+    const wide_float one = broadcast(1.0f);
+    const wide_float two = broadcast(2.0f);
+
+    // the rotation matrix of the quaternion as glm::toMat4() builds it, each column scaled by the
+    // scale along its axis
+    const wide_float xx = mul(x, x);
+    const wide_float yy = mul(y, y);
+    const wide_float zz = mul(z, z);
+    const wide_float xy = mul(x, y);
+    const wide_float xz = mul(x, z);
+    const wide_float yz = mul(y, z);
+    const wide_float wx = mul(w, x);
+    const wide_float wy = mul(w, y);
+    const wide_float wz = mul(w, z);
+    std::array<std::array<float, WIDTH>, 9U> columns {};
+    store(columns[0].data(), mul(sub(one, mul(two, add(yy, zz))), scale_x));
+    store(columns[1].data(), mul(mul(two, add(xy, wz)), scale_x));
+    store(columns[2].data(), mul(mul(two, sub(xz, wy)), scale_x));
+    store(columns[3].data(), mul(mul(two, sub(xy, wz)), scale_y));
+    store(columns[4].data(), mul(sub(one, mul(two, add(xx, zz))), scale_y));
+    store(columns[5].data(), mul(mul(two, add(yz, wx)), scale_y));
+    store(columns[6].data(), mul(mul(two, add(xz, wy)), scale_z));
+    store(columns[7].data(), mul(mul(two, sub(yz, wx)), scale_z));
+    store(columns[8].data(), mul(sub(one, mul(two, add(xx, yy))), scale_z));
+
+    // only the dirty lanes are written back, the others keep their cached matrix
+    for(uint64_t remaining = lanes; remaining != 0U; remaining &= remaining - 1U) {
+        const auto lane = static_cast<std::size_t>(std::countr_zero(remaining));
+        const std::size_t id = first + lane;
+        world_[id] = glm::mat4 {
+            glm::vec4 {columns[0][lane], columns[1][lane], columns[2][lane], 0.0f},
+            glm::vec4 {columns[3][lane], columns[4][lane], columns[5][lane], 0.0f},
+            glm::vec4 {columns[6][lane], columns[7][lane], columns[8][lane], 0.0f},
+            glm::vec4 {translation_x_[id], translation_y_[id], translation_z_[id], 1.0f}};
+    }
+#else
+    compose_scalar(first, lanes);
+#endif
+}
+
+void transform_store::compose_scalar(const std::size_t first, const uint64_t lanes) {
+    for(uint64_t remaining = lanes; remaining != 0U; remaining &= remaining - 1U) {
+        const std::size_t id = first + static_cast<std::size_t>(std::countr_zero(remaining));
+        world_[id] = get(static_cast<handle>(id)).mat4();
+    }
+}
+
+}
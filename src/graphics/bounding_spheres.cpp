@@ -0,0 +1,101 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "arcticvox/graphics/bounding_spheres.hpp"
+#include "arcticvox/graphics/frustum.hpp"
+
+namespace arcticvox::graphics {
+
+namespace {
+/**
+ * @brief Appends the indices of the set bits of a lane mask, offset by the first lane's index
+ */
+void append_lanes(unsigned int mask, const std::size_t first, std::vector<uint32_t>& visible) {
+    while(mask != 0U) {
+        visible.push_back(static_cast<uint32_t>(first + std::countr_zero(mask)));
+        mask &= mask - 1U;
+    }
+}
+}
+
+void bounding_spheres::clear() {
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    radius_.clear();
+}
+
+void bounding_spheres::push_back(const glm::vec3& center, const float radius) {
+    x_.push_back(center.x);
+    y_.push_back(center.y);
+    z_.push_back(center.z);
+    radius_.push_back(radius);
+}
+
+void bounding_spheres::cull(const frustum& view_frustum, std::vector<uint32_t>& visible) const {
+    visible.clear();
+    std::size_t first = 0U;
+
+#if defined(__AVX__)
+    constexpr std::size_t WIDTH = 8U;
+    for(; first + WIDTH <= size(); first += WIDTH) {
+        const __m256 x = _mm256_loadu_ps(x_.data() + first);
+        const __m256 y = _mm256_loadu_ps(y_.data() + first);
+        const __m256 z = _mm256_loadu_ps(z_.data() + first);
+        const __m256 negative_radius =
+            _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius_.data() + first));
+        // a sphere is outside once it lies behind any plane, the lanes still inside stay set
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for(const glm::vec4& plane: view_frustum.planes) {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)),
+                                            _mm256_set1_ps(plane.w));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(plane.y)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(plane.z)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+        }
+        append_lanes(static_cast<unsigned int>(_mm256_movemask_ps(inside)), first, visible);
+    }
+#elif defined(__SSE2__)
+    constexpr std::size_t WIDTH = 4U;
+    for(; first + WIDTH <= size(); first += WIDTH) {
+        const __m128 x = _mm_loadu_ps(x_.data() + first);
+        const __m128 y = _mm_loadu_ps(y_.data() + first);
+        const __m128 z = _mm_loadu_ps(z_.data() + first);
+        const __m128 negative_radius =
+            _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius_.data() + first));
+        // a sphere is outside once it lies behind any plane, the lanes still inside stay set
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(const glm::vec4& plane: view_frustum.planes) {
+            __m128 distance =
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+        }
+        append_lanes(static_cast<unsigned int>(_mm_movemask_ps(inside)), first, visible);
+    }
+#endif
+
+    cull_scalar(view_frustum, first, visible);
+}
+
+void bounding_spheres::cull_scalar(const frustum& view_frustum,
+                                   const std::size_t first,
+                                   std::vector<uint32_t>& visible) const {
+    for(std::size_t sphere = first; sphere < size(); ++sphere) {
+        if(view_frustum.intersects_sphere(glm::vec3 {x_[sphere], y_[sphere], z_[sphere]},
+                                          radius_[sphere]))
+            visible.push_back(static_cast<uint32_t>(sphere));
+    }
+}
+
+}
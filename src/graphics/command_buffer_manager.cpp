@@ -0,0 +1,69 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/command_buffer_manager.hpp"
+
+namespace arcticvox::graphics {
+
+recycling_command_pool::recycling_command_pool(vk::raii::Device& device,
+                                               const uint32_t queue_family) :
+    device_(device),
+    pool_(device_,
+          vk::CommandPoolCreateInfo {.flags = vk::CommandPoolCreateFlagBits::eTransient,
+                                     .queueFamilyIndex = queue_family}) { }
+
+auto recycling_command_pool::acquire(const vk::CommandBufferLevel level)
+    -> vk::raii::CommandBuffer& {
+    recycled_buffers& recycled =
+        (level == vk::CommandBufferLevel::ePrimary) ? primaries_ : secondaries_;
+    if(recycled.used == recycled.buffers.size()) {
+        const vk::CommandBufferAllocateInfo allocate_info {
+            .commandPool = *pool_, .level = level, .commandBufferCount = 1U};
+        recycled.buffers.push_back(
+            std::move(vk::raii::CommandBuffers(device_, allocate_info).front()));
+    }
+    return recycled.buffers[recycled.used++];
+}
+
+auto recycling_command_pool::reset() -> void {
+    // keeps the memory of the command buffers, they are recorded to again right away
+    pool_.reset({});
+    primaries_.used = 0U;
+    secondaries_.used = 0U;
+}
+
+command_buffer_manager::command_buffer_manager(vk::raii::Device& device,
+                                               const uint32_t queue_family,
+                                               const std::size_t slot_count) :
+    device_(device), queue_family_(queue_family), slot_count_(slot_count) { }
+
+auto command_buffer_manager::acquire(const std::size_t slot, const vk::CommandBufferLevel level)
+    -> vk::raii::CommandBuffer& {
+    recycling_command_pool* pool = nullptr;
+    {
+        std::lock_guard lock {mutex_};
+        slot_pools& pools = threads_[std::this_thread::get_id()];
+        if(pools.empty()) {
+            for(std::size_t i = 0U; i < slot_count_; ++i)
+                pools.push_back(std::make_unique<recycling_command_pool>(device_, queue_family_));
+        }
+        pool = pools.at(slot).get();
+    }
+    // only the calling thread records from its pools, the lock is not needed any longer
+    return pool->acquire(level);
+}
+
+auto command_buffer_manager::reset(const std::size_t slot) -> void {
+    std::lock_guard lock {mutex_};
+    for(auto& [thread, pools]: threads_)
+        pools.at(slot)->reset();
+}
+
+}
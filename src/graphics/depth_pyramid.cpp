@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/depth_pyramid.hpp"
+#include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/pipeline.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
+
+namespace arcticvox::graphics {
+
+namespace {
+//! The source level and the level written, in the order of their bindings
+constexpr uint32_t BINDING_COUNT = 2U;
+
+/**
+ * @brief Returns the size of the level following one of the given size, rounded up
+ */
+vk::Extent2D half_extent(const vk::Extent2D extent) {
+    return vk::Extent2D {.width = std::max((extent.width + 1U) / 2U, 1U),
+                         .height = std::max((extent.height + 1U) / 2U, 1U)};
+}
+}
+
+depth_pyramid::depth_pyramid(gpu_driver& driver) :
+    driver_(driver),
+    descriptor_set_layout_(create_descriptor_set_layout()),
+    pipeline_layout_(create_pipeline_layout()),
+    pipeline_(driver_, pyramid_shader_, *pipeline_layout_),
+    descriptor_pool_(create_descriptor_pool()),
+    sampler_(create_sampler()) { }
+
+auto depth_pyramid::build(vk::raii::CommandBuffer& command_buffer,
+                          const uint32_t frame_index,
+                          const depth_attachment& depth) -> void {
+    std::optional<pyramid_image>& pyramid = pyramids_.at(frame_index);
+    // the frame's fence was waited on, its pyramid is no longer read
+    if(!pyramid || (pyramid->depth_extent != depth.extent)) {
+        pyramid.reset();
+        pyramid.emplace(create_pyramid(depth.extent));
+    }
+
+    // the swapchain image, and with it the depth attachment, changes from frame to frame
+    const vk::DescriptorImageInfo depth_info {
+        .sampler = *sampler_,
+        .imageView = depth.view,
+        .imageLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal};
+    driver_.device().updateDescriptorSets(
+        vk::WriteDescriptorSet {.dstSet = *pyramid->descriptor_sets.front(),
+                                .dstBinding = 0U,
+                                .dstArrayElement = 0U,
+                                .descriptorCount = 1U,
+                                .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+                                .pImageInfo = &depth_info},
+        {});
+
+    const std::array<vk::ImageMemoryBarrier, 2U> to_build {
+        vk::ImageMemoryBarrier {
+            .srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+            .oldLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            .newLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = depth.image,
+            .subresourceRange = {.aspectMask = depth.aspect,
+                                 .baseMipLevel = 0U,
+                                 .levelCount = 1U,
+                                 .baseArrayLayer = 0U,
+                                 .layerCount = 1U}},
+        // the pyramid is rebuilt completely, its previous contents are discarded
+        vk::ImageMemoryBarrier {
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .oldLayout = vk::ImageLayout::eUndefined,
+            .newLayout = vk::ImageLayout::eGeneral,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = *pyramid->image,
+            .subresourceRange = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                                 .baseMipLevel = 0U,
+                                 .levelCount = pyramid->level_count,
+                                 .baseArrayLayer = 0U,
+                                 .layerCount = 1U}}};
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eEarlyFragmentTests
+                                       | vk::PipelineStageFlagBits::eLateFragmentTests,
+                                   vk::PipelineStageFlagBits::eComputeShader,
+                                   {},
+                                   {},
+                                   {},
+                                   to_build);
+
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline_.vk_pipeline());
+    vk::Extent2D extent = half_extent(depth.extent);
+    for(uint32_t level = 0U; level < pyramid->level_count; ++level) {
+        command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                          *pipeline_layout_,
+                                          0U,
+                                          *pyramid->descriptor_sets[level],
+                                          {});
+        command_buffer.dispatch((extent.width + WORKGROUP_SIZE - 1U) / WORKGROUP_SIZE,
+                                (extent.height + WORKGROUP_SIZE - 1U) / WORKGROUP_SIZE,
+                                1U);
+        // the next level reads this one, the culling that follows reads all of them
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            vk::MemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                               .dstAccessMask = vk::AccessFlagBits::eShaderRead},
+            {},
+            {});
+        extent = half_extent(extent);
+    }
+}
+
+auto depth_pyramid::create_descriptor_set_layout() -> vk::raii::DescriptorSetLayout {
+    const std::array<vk::DescriptorSetLayoutBinding, BINDING_COUNT> bindings {
+        vk::DescriptorSetLayoutBinding {
+            .binding = 0U,
+            .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+            .descriptorCount = 1U,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},
+        vk::DescriptorSetLayoutBinding {.binding = 1U,
+                                        .descriptorType = vk::DescriptorType::eStorageImage,
+                                        .descriptorCount = 1U,
+                                        .stageFlags = vk::ShaderStageFlagBits::eCompute}};
+    return vk::raii::DescriptorSetLayout {
+        driver_.device(),
+        vk::DescriptorSetLayoutCreateInfo {.bindingCount = BINDING_COUNT,
+                                           .pBindings = bindings.data()}};
+}
+
+auto depth_pyramid::create_pipeline_layout() -> vk::raii::PipelineLayout {
+    const vk::PipelineLayoutCreateInfo pipeline_layout_info {
+        .setLayoutCount = 1U,
+        .pSetLayouts = &*descriptor_set_layout_,
+        .pushConstantRangeCount = 0U,
+        .pPushConstantRanges = nullptr};
+    return vk::raii::PipelineLayout {driver_.device(), pipeline_layout_info};
+}
+
+auto depth_pyramid::create_descriptor_pool() -> vk::raii::DescriptorPool {
+    constexpr uint32_t SET_COUNT = MAX_LEVELS * swapchain::MAX_FRAMES_IN_FLIGHT;
+    const std::array<vk::DescriptorPoolSize, BINDING_COUNT> pool_sizes {
+        vk::DescriptorPoolSize {.type = vk::DescriptorType::eCombinedImageSampler,
+                                .descriptorCount = SET_COUNT},
+        vk::DescriptorPoolSize {.type = vk::DescriptorType::eStorageImage,
+                                .descriptorCount = SET_COUNT}};
+    // the sets are freed along with their pyramid when it is recreated
+    return vk::raii::DescriptorPool {
+        driver_.device(),
+        vk::DescriptorPoolCreateInfo {
+            .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+            .maxSets = SET_COUNT,
+            .poolSizeCount = BINDING_COUNT,
+            .pPoolSizes = pool_sizes.data()}};
+}
+
+auto depth_pyramid::create_sampler() -> vk::raii::Sampler {
+    return vk::raii::Sampler {
+        driver_.device(),
+        vk::SamplerCreateInfo {.magFilter = vk::Filter::eNearest,
+                               .minFilter = vk::Filter::eNearest,
+                               .mipmapMode = vk::SamplerMipmapMode::eNearest,
+                               .addressModeU = vk::SamplerAddressMode::eClampToEdge,
+                               .addressModeV = vk::SamplerAddressMode::eClampToEdge,
+                               .addressModeW = vk::SamplerAddressMode::eClampToEdge,
+                               .mipLodBias = 0.0f,
+                               .anisotropyEnable = vk::False,
+                               .maxAnisotropy = 1.0f,
+                               .compareEnable = vk::False,
+                               .compareOp = vk::CompareOp::eAlways,
+                               .minLod = 0.0f,
+                               .maxLod = VK_LOD_CLAMP_NONE,
+                               .borderColor = vk::BorderColor::eFloatOpaqueWhite,
+                               .unnormalizedCoordinates = vk::False}};
+}
+
+auto depth_pyramid::create_pyramid(const vk::Extent2D depth_extent) -> pyramid_image {
+    const vk::Extent2D base = half_extent(depth_extent);
+    const uint32_t level_count =
+        std::min(static_cast<uint32_t>(std::bit_width(std::max(base.width, base.height))),
+                 MAX_LEVELS);
+
+    vk::raii::Image image {
+        driver_.device(),
+        vk::ImageCreateInfo {.flags = {},
+                             .imageType = vk::ImageType::e2D,
+                             .format = vk::Format::eR32Sfloat,
+                             .extent {.width = base.width, .height = base.height, .depth = 1U},
+                             .mipLevels = level_count,
+                             .arrayLayers = 1U,
+                             .samples = vk::SampleCountFlagBits::e1,
+                             .tiling = vk::ImageTiling::eOptimal,
+                             .usage = vk::ImageUsageFlagBits::eStorage
+                                      | vk::ImageUsageFlagBits::eSampled,
+                             .sharingMode = vk::SharingMode::eExclusive,
+                             .initialLayout = vk::ImageLayout::eUndefined}};
+    memory_allocation memory =
+        driver_.bind_memory_to_image(image, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    const auto create_view = [&](const uint32_t first_level, const uint32_t count) {
+        return vk::raii::ImageView {
+            driver_.device(),
+            vk::ImageViewCreateInfo {.image = *image,
+                                     .viewType = vk::ImageViewType::e2D,
+                                     .format = vk::Format::eR32Sfloat,
+                                     .subresourceRange {.aspectMask =
+                                                            vk::ImageAspectFlagBits::eColor,
+                                                        .baseMipLevel = first_level,
+                                                        .levelCount = count,
+                                                        .baseArrayLayer = 0U,
+                                                        .layerCount = 1U}}};
+    };
+    vk::raii::ImageView view = create_view(0U, level_count);
+    std::vector<vk::raii::ImageView> level_views;
+    for(uint32_t level = 0U; level < level_count; ++level)
+        level_views.push_back(create_view(level, 1U));
+
+    const std::vector<vk::DescriptorSetLayout> layouts(level_count, *descriptor_set_layout_);
+    vk::raii::DescriptorSets descriptor_sets {
+        driver_.device(),
+        vk::DescriptorSetAllocateInfo {.descriptorPool = *descriptor_pool_,
+                                       .descriptorSetCount = level_count,
+                                       .pSetLayouts = layouts.data()}};
+
+    // every level is written to as a storage image and read from by the next level
+    std::vector<vk::DescriptorImageInfo> image_infos;
+    image_infos.reserve(2U * level_count);
+    std::vector<vk::WriteDescriptorSet> writes;
+    for(uint32_t level = 0U; level < level_count; ++level) {
+        image_infos.push_back(vk::DescriptorImageInfo {.sampler = nullptr,
+                                                       .imageView = *level_views[level],
+                                                       .imageLayout = vk::ImageLayout::eGeneral});
+        writes.push_back(
+            vk::WriteDescriptorSet {.dstSet = *descriptor_sets[level],
+                                    .dstBinding = 1U,
+                                    .dstArrayElement = 0U,
+                                    .descriptorCount = 1U,
+                                    .descriptorType = vk::DescriptorType::eStorageImage,
+                                    .pImageInfo = &image_infos.back()});
+        if(level == 0U)
+            continue;
+        image_infos.push_back(vk::DescriptorImageInfo {.sampler = *sampler_,
+                                                       .imageView = *level_views[level - 1U],
+                                                       .imageLayout = vk::ImageLayout::eGeneral});
+        writes.push_back(
+            vk::WriteDescriptorSet {.dstSet = *descriptor_sets[level],
+                                    .dstBinding = 0U,
+                                    .dstArrayElement = 0U,
+                                    .descriptorCount = 1U,
+                                    .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+                                    .pImageInfo = &image_infos.back()});
+    }
+    driver_.device().updateDescriptorSets(writes, {});
+
+    return pyramid_image {.image = std::move(image),
+                          .memory = std::move(memory),
+                          .view = std::move(view),
+                          .level_views = std::move(level_views),
+                          .descriptor_sets = std::move(descriptor_sets),
+                          .depth_extent = depth_extent,
+                          .level_count = level_count};
+}
+
+}
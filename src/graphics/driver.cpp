@@ -1,6 +1,13 @@
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <span>
+#include <stdexcept>
 #include <vector>
 
 #include <vulkan/vulkan.hpp>
@@ -8,45 +15,118 @@
 
 #include <vulkan/vulkan_structs.hpp>
 
+#include <spdlog/spdlog.h>
+
 #include "arcticvox/common/engine_configuration.hpp"
 #include "arcticvox/graphics/driver.hpp"
 #include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/staging_ring.hpp"
 
 namespace arcticvox::graphics {
 
+namespace {
+//! The geometry arena's vertex buffer takes at most a sixth of the device local budget, its index
+//! buffer a twelfth
+constexpr vk::DeviceSize VERTEX_BUDGET_DIVISOR = 6U;
+constexpr vk::DeviceSize INDEX_BUDGET_DIVISOR = 12U;
+//! Without resizable BAR, at most this much device local memory is host visible, too little to
+//! place buffers in
+constexpr vk::DeviceSize BAR_WINDOW_SIZE = 256ULL << 20U;
+
+auto begin_one_time(vk::raii::CommandBuffer& command_buffer) -> vk::raii::CommandBuffer& {
+    command_buffer.begin(
+        vk::CommandBufferBeginInfo {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    return command_buffer;
+}
+}
+
 gpu_driver::gpu_driver(gpu& gpu) :
     gpu_(gpu),
+    queue_families_(gpu_.find_queue_families()),
+    memory_budget_(gpu::check_extension_support(
+        {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME},
+        gpu_.physical_device().enumerateDeviceExtensionProperties())),
+    multi_draw_indirect_(gpu_.physical_device().getFeatures().multiDrawIndirect
+                         && gpu_.physical_device().getFeatures().drawIndirectFirstInstance),
+    draw_indirect_count_(
+        gpu_.physical_device()
+            .getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>()
+            .get<vk::PhysicalDeviceVulkan12Features>()
+            .drawIndirectCount),
     device_(create_device()),
-    graphics_queue_(device_, gpu_.find_queue_families().graphics_family.value(), 0U),
-    present_queue_(device_, gpu_.find_queue_families().present_family.value(), 0U),
-    command_pool_(create_command_pool()) { }
-
-auto gpu_driver::begin_single_time_commands() -> vk::raii::CommandBuffer {
-    vk::CommandBufferAllocateInfo allocate_info {.commandPool = command_pool_,
-                                                 .level = vk::CommandBufferLevel::ePrimary,
-                                                 .commandBufferCount = 1U};
-    vk::raii::CommandBuffer command_buffer =
-        std::move(vk::raii::CommandBuffers(device_, allocate_info).front());
-    vk::CommandBufferBeginInfo begin_info {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
-    command_buffer.begin(begin_info);
-    return command_buffer;
+    allocator_(gpu_, device_, memory_budget_),
+    device_local_properties_(select_device_local_properties()),
+    graphics_queue_(device_, queue_families_.graphics_family.value(), 0U),
+    present_queue_(device_, queue_families_.present_family.value(), 0U),
+    transfer_queue_(device_, queue_families_.upload_family(), 0U),
+    transfer_timeline_(device_,
+                       vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> {
+                           {}, {.semaphoreType = vk::SemaphoreType::eTimeline}}
+                           .get<vk::SemaphoreCreateInfo>()),
+    single_time_pool_(device_, queue_families_.graphics_family.value()),
+    staging_ring_(device_, allocator_),
+    // models beyond the arena's capacity are evicted, so sizing it keeps geometry within budget
+    geometry_arena_(device_,
+                    allocator_,
+                    device_local_properties_,
+                    std::min(geometry_arena::DEFAULT_VERTEX_CAPACITY,
+                             allocator_.device_local_budget() / VERTEX_BUDGET_DIVISOR),
+                    std::min(geometry_arena::DEFAULT_INDEX_CAPACITY,
+                             allocator_.device_local_budget() / INDEX_BUDGET_DIVISOR)) {
+    if(queue_families_.transfer_family)
+        spdlog::info("Uploading on transfer queue family {}", *queue_families_.transfer_family);
+    if(!multi_draw_indirect_)
+        spdlog::info("Multi draw indirect is not supported, drawing objects one by one");
+}
+
+auto gpu_driver::begin_single_time_commands() -> vk::raii::CommandBuffer& {
+    return begin_one_time(single_time_pool_.acquire());
+}
+
+auto gpu_driver::begin_upload_batch() -> upload_pools& {
+    // the device is done with the pools of released batches
+    while(!upload_pools_.empty()
+          && (upload_pools_.front()->ticket <= staging_ring_.released_ticket())) {
+        upload_pools_.front()->transfer.reset();
+        upload_pools_.front()->graphics.reset();
+        free_upload_pools_.push_back(std::move(upload_pools_.front()));
+        upload_pools_.pop_front();
+    }
+
+    std::unique_ptr<upload_pools> pools;
+    if(free_upload_pools_.empty()) {
+        pools = std::make_unique<upload_pools>(
+            device_, queue_families_.upload_family(), queue_families_.graphics_family.value());
+    } else {
+        pools = std::move(free_upload_pools_.back());
+        free_upload_pools_.pop_back();
+    }
+    // a batch that is not submitted shares the ticket of the next one
+    pools->ticket = staging_ring_.next_ticket();
+    upload_pools_.push_back(std::move(pools));
+    return *upload_pools_.back();
 }
 
 auto gpu_driver::bind_memory_to_buffer(vk::raii::Buffer& buffer, vk::MemoryPropertyFlags properties)
-    -> vk::raii::DeviceMemory {
-    vk::MemoryRequirements memory_requirements = buffer.getMemoryRequirements();
-    vk::MemoryAllocateInfo memory_alloc_info {
-        .allocationSize = memory_requirements.size,
-        .memoryTypeIndex = gpu_.find_memory_type(memory_requirements.memoryTypeBits, properties)};
+    -> memory_allocation {
+    memory_allocation allocation = allocator_.allocate(
+        buffer.getMemoryRequirements(), properties, memory_allocator::resource_kind::linear);
+    buffer.bindMemory(allocation.memory(), allocation.offset());
+    return allocation;
+}
 
-    vk::raii::DeviceMemory memory = device_.allocateMemory(memory_alloc_info);
-    buffer.bindMemory(memory, 0U);
-    return memory;
+auto gpu_driver::bind_memory_to_image(const vk::raii::Image& image,
+                                      vk::MemoryPropertyFlags properties) -> memory_allocation {
+    memory_allocation allocation = allocator_.allocate(
+        image.getMemoryRequirements(), properties, memory_allocator::resource_kind::optimal);
+    image.bindMemory(allocation.memory(), allocation.offset());
+    return allocation;
 }
 
 auto gpu_driver::copy_buffer(vk::raii::Buffer& src, vk::raii::Buffer& dst, const vk::DeviceSize sz)
     -> void {
-    vk::raii::CommandBuffer command_buffer = begin_single_time_commands();
+    const std::unique_lock lock = lock_uploads();
+    vk::raii::CommandBuffer& command_buffer = begin_single_time_commands();
     vk::BufferCopy copy_region {.srcOffset = 0U, .dstOffset = 0U, .size = sz};
     command_buffer.copyBuffer(*src, *dst, copy_region);
     end_single_time_commands(command_buffer);
@@ -59,22 +139,12 @@ auto gpu_driver::create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage)
     return device_.createBuffer(buffer_create_info);
 }
 
-auto gpu_driver::create_command_pool() -> vk::raii::CommandPool {
-    queue_family_indices indices = gpu_.find_queue_families();
-    vk::CommandPoolCreateInfo command_pool_create_info {
-        .flags = vk::CommandPoolCreateFlagBits::eTransient
-                 | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-        .queueFamilyIndex = *indices.graphics_family};
-    return vk::raii::CommandPool {device_, command_pool_create_info};
-}
-
 auto gpu_driver::create_device() -> vk::raii::Device {
-    queue_family_indices queue_indices = gpu_.find_queue_families();
-
     float queue_priority = 1.f;
     std::vector<vk::DeviceQueueCreateInfo> queue_create_infos {};
-    std::set<uint32_t> unique_families = {*queue_indices.graphics_family,
-                                          *queue_indices.present_family};
+    std::set<uint32_t> unique_families = {*queue_families_.graphics_family,
+                                          *queue_families_.present_family,
+                                          queue_families_.upload_family()};
 
     std::for_each(unique_families.begin(), unique_families.end(), [&](const uint32_t family) {
         queue_create_infos.push_back(
@@ -85,31 +155,214 @@ auto gpu_driver::create_device() -> vk::raii::Device {
     });
 
     engine_configuration& config = gpu_.get_engine_configuration();
+    std::vector<const char*> extensions = config.device_extensions;
+    if(memory_budget_
+       && std::none_of(extensions.cbegin(), extensions.cend(), [](const char* extension) {
+              return std::strcmp(extension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+          }))
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
     vk::PhysicalDeviceFeatures features {};
     features.samplerAnisotropy = true;
+    features.multiDrawIndirect = multi_draw_indirect_;
+    features.drawIndirectFirstInstance = multi_draw_indirect_;
+    vk::PhysicalDeviceVulkan12Features vulkan12_features {.drawIndirectCount = draw_indirect_count_,
+                                                          .timelineSemaphore = true};
 
     vk::DeviceCreateInfo device_create_info {
+        .pNext = &vulkan12_features,
         .flags = {},
         .queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size()),
         .pQueueCreateInfos = queue_create_infos.data(),
         .enabledLayerCount = static_cast<uint32_t>(config.validation_layers.size()),
         .ppEnabledLayerNames = config.validation_layers.data(),
-        .enabledExtensionCount = static_cast<uint32_t>(config.device_extensions.size()),
-        .ppEnabledExtensionNames = config.device_extensions.data(),
+        .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
+        .ppEnabledExtensionNames = extensions.data(),
         .pEnabledFeatures = &features};
 
     return vk::raii::Device(gpu_.physical_device(), device_create_info);
 }
 
+auto gpu_driver::select_device_local_properties() const -> vk::MemoryPropertyFlags {
+    const vk::MemoryPropertyFlags direct = vk::MemoryPropertyFlagBits::eDeviceLocal
+                                           | vk::MemoryPropertyFlagBits::eHostVisible
+                                           | vk::MemoryPropertyFlagBits::eHostCoherent;
+    const vk::PhysicalDeviceMemoryProperties properties =
+        gpu_.physical_device().getMemoryProperties();
+    for(uint32_t type = 0U; type < properties.memoryTypeCount; ++type) {
+        const vk::MemoryType& candidate = properties.memoryTypes[type];
+        if(((candidate.propertyFlags & direct) == direct)
+           && (properties.memoryHeaps[candidate.heapIndex].size > BAR_WINDOW_SIZE)) {
+            spdlog::info("Device local memory type {} is host visible, writing buffers directly",
+                         type);
+            return direct;
+        }
+    }
+    return vk::MemoryPropertyFlagBits::eDeviceLocal;
+}
+
 auto gpu_driver::end_single_time_commands(vk::raii::CommandBuffer& command_buffer) -> void {
+    const vk::raii::Fence fence = submit_single_time_commands(command_buffer);
+    if(device_.waitForFences({*fence}, vk::True, std::numeric_limits<uint64_t>::max())
+       != vk::Result::eSuccess)
+        throw std::runtime_error("Failed waiting for single time commands");
+    single_time_pool_.reset();
+}
+
+auto gpu_driver::submit_single_time_commands(vk::raii::CommandBuffer& command_buffer)
+    -> vk::raii::Fence {
     command_buffer.end();
     vk::SubmitInfo submit_info {
         .commandBufferCount = 1U,
         .pCommandBuffers = &(*command_buffer),
     };
-    graphics_queue_.submit(submit_info);
-    graphics_queue_.waitIdle();
+    vk::raii::Fence fence {device_, vk::FenceCreateInfo {}};
+    {
+        std::lock_guard lock {queue_mutex_};
+        graphics_queue_.submit(submit_info, *fence);
+    }
+    return fence;
+}
+
+auto gpu_driver::submit_staged(upload_pools& pools,
+                               vk::raii::CommandBuffer& command_buffer,
+                               std::span<const vk::BufferMemoryBarrier> destinations)
+    -> uint64_t {
+    const uint64_t ticket = staging_ring_.next_ticket();
+    const auto submit = [this, ticket](vk::raii::Queue& queue,
+                                       const vk::raii::CommandBuffer& commands,
+                                       const vk::raii::Semaphore* wait,
+                                       const vk::raii::Semaphore& signal) {
+        const vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eAllCommands;
+        const vk::TimelineSemaphoreSubmitInfo timeline_info {
+            .waitSemaphoreValueCount = wait ? 1U : 0U,
+            .pWaitSemaphoreValues = &ticket,
+            .signalSemaphoreValueCount = 1U,
+            .pSignalSemaphoreValues = &ticket};
+        const vk::SubmitInfo submit_info {.pNext = &timeline_info,
+                                          .waitSemaphoreCount = wait ? 1U : 0U,
+                                          .pWaitSemaphores = wait ? &(**wait) : nullptr,
+                                          .pWaitDstStageMask = &wait_stage,
+                                          .commandBufferCount = 1U,
+                                          .pCommandBuffers = &(*commands),
+                                          .signalSemaphoreCount = 1U,
+                                          .pSignalSemaphores = &(*signal)};
+        std::lock_guard lock {queue_mutex_};
+        queue.submit(submit_info);
+    };
+
+    const uint32_t graphics_family = queue_families_.graphics_family.value();
+    const uint32_t transfer_family = queue_families_.upload_family();
+    std::vector<vk::BufferMemoryBarrier> barriers(destinations.begin(), destinations.end());
+
+    if(transfer_family == graphics_family) {
+        // a single queue, the barrier covers all later submissions in submission order
+        for(vk::BufferMemoryBarrier& barrier: barriers)
+            barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+        command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                       vk::PipelineStageFlagBits::eAllCommands,
+                                       {},
+                                       {},
+                                       barriers,
+                                       {});
+        command_buffer.end();
+        submit(transfer_queue_, command_buffer, nullptr, staging_ring_.timeline());
+        return staging_ring_.submit();
+    }
+
+    // release the ranges on the transfer queue
+    for(vk::BufferMemoryBarrier& barrier: barriers) {
+        barrier.srcQueueFamilyIndex = transfer_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+    }
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eBottomOfPipe,
+                                   {},
+                                   {},
+                                   barriers,
+                                   {});
+    command_buffer.end();
+    submit(transfer_queue_, command_buffer, nullptr, transfer_timeline_);
+
+    // and acquire them on the graphics queue once the copies have finished
+    for(vk::BufferMemoryBarrier& barrier: barriers) {
+        barrier.srcAccessMask = {};
+        barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+    }
+    vk::raii::CommandBuffer& acquire = begin_one_time(pools.graphics.acquire());
+    acquire.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                            vk::PipelineStageFlagBits::eAllCommands,
+                            {},
+                            {},
+                            barriers,
+                            {});
+    acquire.end();
+    submit(graphics_queue_, acquire, &transfer_timeline_, staging_ring_.timeline());
+    return staging_ring_.submit();
+}
+
+auto gpu_driver::upload_buffers(std::span<const buffer_upload> uploads) -> uint64_t {
+    const std::unique_lock lock = lock_uploads();
+    staging_ring_.retire();
+
+    // the batch is begun once the first chunk is staged, direct writes need no command buffer
+    upload_pools* pools = nullptr;
+    vk::raii::CommandBuffer* command_buffer = nullptr;
+    std::vector<vk::BufferMemoryBarrier> destinations;
+    for(const buffer_upload& upload: uploads) {
+        const auto* source = static_cast<const std::byte*>(upload.data);
+        if(upload.mapped_destination) {
+            std::memcpy(upload.mapped_destination + upload.destination_offset, source, upload.size);
+            continue;
+        }
+
+        vk::DeviceSize copied = 0U;
+        while(copied < upload.size) {
+            // uploads larger than the ring are split, as are those that do not fit at once
+            const vk::DeviceSize chunk = std::min(upload.size - copied, staging_ring_.size());
+            const std::optional<staging_ring::region> region = staging_ring_.allocate(chunk);
+            if(!region) {
+                if(!destinations.empty()) {
+                    // the ring is full of this call's own data, hand it to the device
+                    submit_staged(*pools, *command_buffer, destinations);
+                    pools = nullptr;
+                    command_buffer = nullptr;
+                    destinations.clear();
+                }
+                if(!staging_ring_.wait_oldest())
+                    throw std::runtime_error("Staging ring is full without uploads in flight");
+                continue;
+            }
+
+            std::memcpy(region->data, source + copied, chunk);
+            if(!pools) {
+                pools = &begin_upload_batch();
+                command_buffer = &begin_one_time(pools->transfer.acquire());
+            }
+            const vk::BufferCopy copy_region {.srcOffset = region->offset,
+                                              .dstOffset = upload.destination_offset + copied,
+                                              .size = chunk};
+            command_buffer->copyBuffer(*staging_ring_.buffer(), upload.destination, copy_region);
+            destinations.push_back(
+                vk::BufferMemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                                         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                         .buffer = upload.destination,
+                                         .offset = copy_region.dstOffset,
+                                         .size = chunk});
+            copied += chunk;
+        }
+    }
+
+    // written directly or empty, there is nothing to wait for
+    if(destinations.empty())
+        return 0U;
+    return submit_staged(*pools, *command_buffer, destinations);
+}
+
+auto gpu_driver::wait_for_upload(const uint64_t ticket) -> void {
+    const std::unique_lock lock = lock_uploads();
+    staging_ring_.wait(ticket);
 }
 
 }
@@ -1,10 +1,17 @@
 #include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <utility>
 
 #include <vulkan/vulkan_raii.hpp>
 
 #include "arcticvox/common/engine_configuration.hpp"
+#include "arcticvox/components/transform_store.hpp"
 #include "arcticvox/graphics/camera.hpp"
 #include "arcticvox/graphics/engine.hpp"
+#include "arcticvox/graphics/geometry_arena.hpp"
+#include "arcticvox/graphics/model_streamer.hpp"
 #include "arcticvox/graphics/render_system.hpp"
 #include "arcticvox/graphics/window.hpp"
 
@@ -15,7 +22,12 @@ graphics_engine::graphics_engine(engine_configuration& config, window& window) :
     gpu_(config, window_),
     driver_(gpu_),
     renderer_(gpu_, driver_, window_, false),
-    render_sys_(gpu_, driver_, renderer_.get_swapchain().render_pass()) { }
+    render_sys_(gpu_,
+                driver_,
+                renderer_.get_swapchain().render_pass(),
+                renderer_.command_buffers(),
+                transforms_),
+    streamer_(driver_) { }
 
 void graphics_engine::run() {
     std::chrono::time_point<std::chrono::high_resolution_clock> current_time =
@@ -33,9 +45,33 @@ void graphics_engine::run() {
             camera_->update(frame_time);
 
             if(vk::raii::CommandBuffer* cmd_buffer = renderer_.begin_frame()) {
-                renderer_.begin_swapchain_renderpass(*cmd_buffer);
-                render_sys_.render_gameobjects(*cmd_buffer, *render_objects_, *camera_);
+                swap_in_streamed_models(renderer_.frame_index());
+                // evictions leave holes, which the compaction right after can close
+                streamer_.update_residency(frame_number_++);
+                compact_geometry(*cmd_buffer, renderer_.frame_index());
+                // only the transforms set since the last frame are composed again
+                transforms_.update();
+                // the culling compute pass runs before the render pass begins
+                render_sys_.cull_gameobjects(
+                    *cmd_buffer, *render_objects_, *camera_, renderer_.frame_index());
+                renderer_.begin_swapchain_renderpass(*cmd_buffer,
+                                                     render_sys_.subpass_contents());
+                render_sys_.render_gameobjects(*cmd_buffer,
+                                               *render_objects_,
+                                               *camera_,
+                                               renderer_.get_swapchain().get_extent(),
+                                               renderer_.frame_index(),
+                                               renderer_.swapchain_inheritance());
                 renderer_.end_swapchain_renderpass(*cmd_buffer);
+                // what the first pass hid is drawn in a second one, on top of its depth
+                if(render_sys_.occlusion_culling()) {
+                    render_sys_.cull_occluded(*cmd_buffer,
+                                              renderer_.frame_index(),
+                                              renderer_.current_depth_attachment());
+                    renderer_.resume_swapchain_renderpass(*cmd_buffer);
+                    render_sys_.render_disoccluded(*cmd_buffer, renderer_.frame_index());
+                    renderer_.end_swapchain_renderpass(*cmd_buffer);
+                }
                 renderer_.end_frame();
             }
         }
@@ -51,7 +87,40 @@ void graphics_engine::run() {
         }
         glfwPollEvents();
     }
+    streamer_.wait_idle();
+    const std::lock_guard lock {driver_.queue_mutex()};
     driver_.device().waitIdle();
 }
 
+void graphics_engine::swap_in_streamed_models(const uint32_t frame_index) {
+    // the frame's fence was waited on in begin_frame(), nothing retired in it is in use anymore
+    retired_models_.at(frame_index).clear();
+
+    for(components::gameobject& obj: *render_objects_) {
+        if(!obj.pending_model.valid())
+            continue;
+
+        switch(obj.pending_model.state()) {
+        case components::model_handle::load_state::loading:
+            break;
+        case components::model_handle::load_state::resident:
+            if(obj.model)
+                retired_models_.at(frame_index).push_back(std::move(obj.model));
+            obj.model = obj.pending_model.get();
+            obj.pending_model.reset();
+            break;
+        case components::model_handle::load_state::failed:
+            obj.pending_model.reset();
+            break;
+        }
+    }
+}
+
+void graphics_engine::compact_geometry(vk::raii::CommandBuffer& command_buffer,
+                                       const uint32_t frame_index) {
+    // the frame's fence was waited on, the buffers replaced when it was last recorded are unused
+    retired_geometry_.at(frame_index).reset();
+    retired_geometry_.at(frame_index) = driver_.geometry().compact(command_buffer);
+}
+
 }
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include "arcticvox/graphics/geometry_arena.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/range_allocator.hpp"
+
+namespace arcticvox::graphics {
+
+namespace {
+const vk::BufferUsageFlags VERTEX_USAGE = vk::BufferUsageFlagBits::eVertexBuffer
+                                          | vk::BufferUsageFlagBits::eTransferDst
+                                          | vk::BufferUsageFlagBits::eTransferSrc;
+const vk::BufferUsageFlags INDEX_USAGE = vk::BufferUsageFlagBits::eIndexBuffer
+                                         | vk::BufferUsageFlagBits::eTransferDst
+                                         | vk::BufferUsageFlagBits::eTransferSrc;
+}
+
+geometry_allocation::geometry_allocation(geometry_allocation&& other) noexcept :
+    arena_(std::exchange(other.arena_, nullptr)),
+    entry_(other.entry_) { }
+
+geometry_allocation::~geometry_allocation() {
+    reset();
+}
+
+geometry_allocation& geometry_allocation::operator=(geometry_allocation&& other) noexcept {
+    if(this != &other) {
+        reset();
+        arena_ = std::exchange(other.arena_, nullptr);
+        entry_ = other.entry_;
+    }
+    return *this;
+}
+
+vk::DeviceSize geometry_allocation::vertex_offset() const {
+    return entry_->vertex_offset;
+}
+
+vk::DeviceSize geometry_allocation::index_offset() const {
+    return entry_->index_offset;
+}
+
+int32_t geometry_allocation::first_vertex() const {
+    return static_cast<int32_t>(entry_->vertex_offset / entry_->vertex_stride);
+}
+
+uint32_t geometry_allocation::first_index() const {
+    return static_cast<uint32_t>(entry_->index_offset / entry_->index_stride);
+}
+
+void geometry_allocation::mark_uploaded() {
+    const std::lock_guard lock {arena_->mutex_};
+    if(!entry_->uploaded) {
+        entry_->uploaded = true;
+        --arena_->pending_uploads_;
+    }
+}
+
+void geometry_allocation::reset() {
+    if(arena_)
+        arena_->free(*this);
+    arena_ = nullptr;
+}
+
+geometry_arena::geometry_arena(vk::raii::Device& device,
+                               memory_allocator& allocator,
+                               const vk::MemoryPropertyFlags properties,
+                               const vk::DeviceSize vertex_capacity,
+                               const vk::DeviceSize index_capacity) :
+    device_(device),
+    allocator_(allocator),
+    properties_(properties),
+    vertex_buffer_(create_buffer(vertex_capacity, VERTEX_USAGE)),
+    vertex_memory_(allocator_.allocate(vertex_buffer_.getMemoryRequirements(),
+                                       properties_,
+                                       memory_allocator::resource_kind::linear)),
+    index_buffer_(create_buffer(index_capacity, INDEX_USAGE)),
+    index_memory_(allocator_.allocate(index_buffer_.getMemoryRequirements(),
+                                      properties_,
+                                      memory_allocator::resource_kind::linear)),
+    vertex_ranges_(vertex_capacity),
+    index_ranges_(index_capacity) {
+    vertex_buffer_.bindMemory(vertex_memory_.memory(), vertex_memory_.offset());
+    index_buffer_.bindMemory(index_memory_.memory(), index_memory_.offset());
+}
+
+auto geometry_arena::allocate(const vk::DeviceSize vertex_size,
+                              const vk::DeviceSize vertex_stride,
+                              const vk::DeviceSize index_size,
+                              const vk::DeviceSize index_stride) -> geometry_allocation {
+    const std::lock_guard lock {mutex_};
+    const std::optional<vk::DeviceSize> vertex_offset =
+        vertex_ranges_.allocate(vertex_size, vertex_stride);
+    if(!vertex_offset) {
+        allocation_failed_ = true;
+        throw std::runtime_error("Geometry arena has no room for the vertices");
+    }
+
+    std::optional<vk::DeviceSize> index_offset {0U};
+    if(index_size > 0U) {
+        index_offset = index_ranges_.allocate(index_size, index_stride);
+        if(!index_offset) {
+            vertex_ranges_.free(*vertex_offset, vertex_size);
+            allocation_failed_ = true;
+            throw std::runtime_error("Geometry arena has no room for the indices");
+        }
+    }
+
+    entries_.push_back(geometry_allocation::entry {.vertex_offset = *vertex_offset,
+                                                   .vertex_size = vertex_size,
+                                                   .vertex_stride = vertex_stride,
+                                                   .index_offset = *index_offset,
+                                                   .index_size = index_size,
+                                                   .index_stride = index_stride});
+    ++pending_uploads_;
+
+    geometry_allocation allocation {};
+    allocation.arena_ = this;
+    allocation.entry_ = std::prev(entries_.end());
+    return allocation;
+}
+
+auto geometry_arena::compact(vk::raii::CommandBuffer& command_buffer)
+    -> std::optional<retired_buffers> {
+    const std::lock_guard lock {mutex_};
+    if((pending_uploads_ > 0U) || !is_fragmented())
+        return std::nullopt;
+
+    retired_buffers retired {.vertex_buffer = create_buffer(vertex_ranges_.size(), VERTEX_USAGE),
+                             .vertex_memory = {},
+                             .index_buffer = create_buffer(index_ranges_.size(), INDEX_USAGE),
+                             .index_memory = {}};
+    retired.vertex_memory = allocator_.allocate(retired.vertex_buffer.getMemoryRequirements(),
+                                                properties_,
+                                                memory_allocator::resource_kind::linear);
+    retired.index_memory = allocator_.allocate(retired.index_buffer.getMemoryRequirements(),
+                                               properties_,
+                                               memory_allocator::resource_kind::linear);
+    retired.vertex_buffer.bindMemory(retired.vertex_memory.memory(),
+                                     retired.vertex_memory.offset());
+    retired.index_buffer.bindMemory(retired.index_memory.memory(), retired.index_memory.offset());
+    // the new buffers become the arena's, the current ones are handed back
+    std::swap(retired.vertex_buffer, vertex_buffer_);
+    std::swap(retired.vertex_memory, vertex_memory_);
+    std::swap(retired.index_buffer, index_buffer_);
+    std::swap(retired.index_memory, index_memory_);
+
+    // a fresh allocator hands out ranges back to back, in the order of the entries
+    vertex_ranges_ = range_allocator {vertex_ranges_.size()};
+    index_ranges_ = range_allocator {index_ranges_.size()};
+    std::vector<vk::BufferCopy> vertex_copies;
+    std::vector<vk::BufferCopy> index_copies;
+    for(geometry_allocation::entry& moved: entries_) {
+        const vk::DeviceSize vertex_offset =
+            *vertex_ranges_.allocate(moved.vertex_size, moved.vertex_stride);
+        vertex_copies.push_back(vk::BufferCopy {.srcOffset = moved.vertex_offset,
+                                                .dstOffset = vertex_offset,
+                                                .size = moved.vertex_size});
+        moved.vertex_offset = vertex_offset;
+
+        if(moved.index_size == 0U)
+            continue;
+        const vk::DeviceSize index_offset =
+            *index_ranges_.allocate(moved.index_size, moved.index_stride);
+        index_copies.push_back(vk::BufferCopy {.srcOffset = moved.index_offset,
+                                               .dstOffset = index_offset,
+                                               .size = moved.index_size});
+        moved.index_offset = index_offset;
+    }
+
+    if(!vertex_copies.empty())
+        command_buffer.copyBuffer(*retired.vertex_buffer, *vertex_buffer_, vertex_copies);
+    if(!index_copies.empty())
+        command_buffer.copyBuffer(*retired.index_buffer, *index_buffer_, index_copies);
+
+    const std::array<vk::BufferMemoryBarrier, 2U> barriers {
+        vk::BufferMemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                                 .dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead,
+                                 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                 .buffer = *vertex_buffer_,
+                                 .offset = 0U,
+                                 .size = VK_WHOLE_SIZE},
+        vk::BufferMemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                                 .dstAccessMask = vk::AccessFlagBits::eIndexRead,
+                                 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                 .buffer = *index_buffer_,
+                                 .offset = 0U,
+                                 .size = VK_WHOLE_SIZE}};
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eVertexInput,
+                                   {},
+                                   {},
+                                   barriers,
+                                   {});
+    spdlog::debug("Compacted geometry arena, {} models moved", entries_.size());
+    return retired;
+}
+
+auto geometry_arena::usage() const -> float {
+    const std::lock_guard lock {mutex_};
+    const auto allocated = [](const range_allocator& ranges) {
+        return 1.0f
+               - static_cast<float>(ranges.free_bytes()) / static_cast<float>(ranges.size());
+    };
+    return std::max(allocated(vertex_ranges_), allocated(index_ranges_));
+}
+
+auto geometry_arena::take_allocation_failure() -> bool {
+    const std::lock_guard lock {mutex_};
+    return std::exchange(allocation_failed_, false);
+}
+
+auto geometry_arena::free(geometry_allocation& allocation) -> void {
+    const std::lock_guard lock {mutex_};
+    const geometry_allocation::entry& freed = *allocation.entry_;
+    vertex_ranges_.free(freed.vertex_offset, freed.vertex_size);
+    if(freed.index_size > 0U)
+        index_ranges_.free(freed.index_offset, freed.index_size);
+    if(!freed.uploaded)
+        --pending_uploads_;
+    entries_.erase(allocation.entry_);
+}
+
+auto geometry_arena::is_fragmented() const -> bool {
+    const auto fragmented = [](const range_allocator& ranges) {
+        const vk::DeviceSize scattered = ranges.free_bytes() - ranges.largest_free_range();
+        return static_cast<float>(scattered)
+               > COMPACTION_THRESHOLD * static_cast<float>(ranges.size());
+    };
+    return fragmented(vertex_ranges_) || fragmented(index_ranges_);
+}
+
+auto geometry_arena::create_buffer(const vk::DeviceSize size,
+                                   const vk::BufferUsageFlags usage) const -> vk::raii::Buffer {
+    return vk::raii::Buffer {
+        device_,
+        vk::BufferCreateInfo {
+            .size = size, .usage = usage, .sharingMode = vk::SharingMode::eExclusive}};
+}
+
+}
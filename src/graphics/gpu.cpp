@@ -203,8 +203,14 @@ bool gpu::check_gpu_suitability(vk::raii::PhysicalDevice device,
         swapchain_adequate = !details.surface_formats.empty() && !details.present_modes.empty();
     }
 
+    const bool timeline_supported =
+        (device.getProperties().apiVersion >= VK_API_VERSION_1_2)
+        && device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>()
+               .get<vk::PhysicalDeviceVulkan12Features>()
+               .timelineSemaphore;
+
     return device.getFeatures().samplerAnisotropy && extension_supported && indices.is_complete()
-           && swapchain_adequate;
+           && swapchain_adequate && timeline_supported;
 }
 
 bool gpu::check_validation_layer_support(
@@ -255,10 +261,20 @@ queue_family_indices gpu::find_queue_families(vk::raii::PhysicalDevice& device,
             indices.graphics_family = i;
         if(queue_families[i].queueCount && device.getSurfaceSupportKHR(i, surface))
             indices.present_family = i;
-        if(indices.is_complete())
+        if(indices.is_complete()) {
+            // prefer a family that can neither draw nor dispatch, it maps to the DMA engines
+            for(size_t j = 0U; j < queue_families.size(); ++j) {
+                const vk::QueueFlags flags = queue_families[j].queueFlags;
+                if(queue_families[j].queueCount && (flags & vk::QueueFlagBits::eTransfer)
+                   && !(flags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))) {
+                    indices.transfer_family = j;
+                    break;
+                }
+            }
             return indices;
+        }
     }
-    return queue_family_indices {std::nullopt, std::nullopt};
+    return queue_family_indices {std::nullopt, std::nullopt, std::nullopt};
 }
 
 vk::Format gpu::find_supported_format(const std::vector<vk::Format>& candidates,
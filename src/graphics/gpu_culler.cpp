@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/frustum.hpp"
+#include "arcticvox/graphics/gpu_culler.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/pipeline.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
+
+namespace arcticvox::graphics {
+
+namespace {
+//! Candidates, instances, commands, counts and visibility, in the order of their bindings
+constexpr uint32_t BINDING_COUNT = 5U;
+//! The first pass and the occlusion pass
+constexpr uint32_t PASS_COUNT = 2U;
+}
+
+gpu_culler::gpu_culler(gpu_driver& driver) :
+    driver_(driver),
+    descriptor_set_layout_(create_descriptor_set_layout()),
+    pyramid_set_layout_(create_pyramid_set_layout()),
+    pipeline_layout_(create_pipeline_layout()),
+    occlusion_pipeline_layout_(create_occlusion_pipeline_layout()),
+    pipeline_(driver_, cull_shader_, *pipeline_layout_),
+    occlusion_pipeline_(driver_, occlusion_shader_, *occlusion_pipeline_layout_),
+    descriptor_pool_(create_descriptor_pool()),
+    descriptor_sets_(allocate_descriptor_sets(*descriptor_set_layout_)),
+    pyramid_sets_(allocate_descriptor_sets(*pyramid_set_layout_)) { }
+
+auto gpu_culler::record(vk::raii::CommandBuffer& command_buffer,
+                        const uint32_t frame_index,
+                        const std::span<const candidate> candidates,
+                        const uint32_t batch_count,
+                        const vk::Buffer instances,
+                        const frustum& view_frustum,
+                        const bool occlusion) -> void {
+    frame_resources& frame = frames_.at(frame_index);
+    frame.candidate_count = static_cast<uint32_t>(candidates.size());
+    frame.batch_count = batch_count;
+    const vk::DeviceSize candidate_size = candidates.size() * sizeof(candidate);
+    // at most every candidate is visible, each writes one command in one of the passes
+    const vk::DeviceSize command_size =
+        PASS_COUNT * candidates.size() * sizeof(vk::DrawIndexedIndirectCommand);
+    const vk::DeviceSize count_size = PASS_COUNT * std::max(batch_count, 1U) * sizeof(uint32_t);
+    const vk::DeviceSize visibility_size = candidates.size() * sizeof(uint32_t);
+
+    culling_buffer& candidate_buffer =
+        reserve(frame.candidates,
+                candidate_size,
+                vk::BufferUsageFlagBits::eStorageBuffer,
+                vk::MemoryPropertyFlagBits::eHostVisible
+                    | vk::MemoryPropertyFlagBits::eHostCoherent,
+                MIN_CANDIDATE_CAPACITY * sizeof(candidate));
+    culling_buffer& command_output =
+        reserve(frame.commands,
+                command_size,
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                PASS_COUNT * MIN_CANDIDATE_CAPACITY * sizeof(vk::DrawIndexedIndirectCommand));
+    culling_buffer& count_output =
+        reserve(frame.counts,
+                count_size,
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer
+                    | vk::BufferUsageFlagBits::eTransferDst,
+                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                0U);
+    const vk::Buffer previous_visibility =
+        frame.visibility ? *frame.visibility->buffer : vk::Buffer {};
+    culling_buffer& visibility =
+        reserve(frame.visibility,
+                visibility_size,
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                MIN_CANDIDATE_CAPACITY * sizeof(uint32_t));
+    if(!candidates.empty())
+        std::memcpy(candidate_buffer.memory.mapped(), candidates.data(), candidate_size);
+
+    // the buffers may have been recreated since the frame's set was last written
+    const std::array<vk::DescriptorBufferInfo, BINDING_COUNT> buffer_infos {
+        vk::DescriptorBufferInfo {
+            .buffer = *candidate_buffer.buffer, .offset = 0U, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo {.buffer = instances, .offset = 0U, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo {
+            .buffer = *command_output.buffer, .offset = 0U, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo {
+            .buffer = *count_output.buffer, .offset = 0U, .range = VK_WHOLE_SIZE},
+        vk::DescriptorBufferInfo {
+            .buffer = *visibility.buffer, .offset = 0U, .range = VK_WHOLE_SIZE}};
+    std::array<vk::WriteDescriptorSet, BINDING_COUNT> writes {};
+    for(uint32_t binding = 0U; binding < BINDING_COUNT; ++binding)
+        writes[binding] =
+            vk::WriteDescriptorSet {.dstSet = *descriptor_sets_[frame_index],
+                                    .dstBinding = binding,
+                                    .dstArrayElement = 0U,
+                                    .descriptorCount = 1U,
+                                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                    .pBufferInfo = &buffer_infos[binding]};
+    driver_.device().updateDescriptorSets(writes, {});
+
+    command_buffer.fillBuffer(*count_output.buffer, 0U, count_size, 0U);
+    // a new visibility buffer starts out with nothing visible, the occlusion pass draws it all
+    if(*visibility.buffer != previous_visibility)
+        command_buffer.fillBuffer(*visibility.buffer, 0U, visibility.size, 0U);
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        vk::MemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                           .dstAccessMask = vk::AccessFlagBits::eShaderRead
+                                            | vk::AccessFlagBits::eShaderWrite},
+        {},
+        {});
+
+    if(!candidates.empty()) {
+        const push_constants push_data {.planes = view_frustum.planes,
+                                        .candidate_count = frame.candidate_count,
+                                        .occlusion = occlusion ? 1U : 0U};
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline_.vk_pipeline());
+        command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                          *pipeline_layout_,
+                                          0U,
+                                          *descriptor_sets_[frame_index],
+                                          {});
+        command_buffer.pushConstants<push_constants>(
+            *pipeline_layout_, vk::ShaderStageFlagBits::eCompute, 0U, push_data);
+        command_buffer.dispatch(
+            static_cast<uint32_t>((candidates.size() + WORKGROUP_SIZE - 1U) / WORKGROUP_SIZE),
+            1U,
+            1U);
+    }
+
+    // the indirect draws read what the culling wrote, the occlusion pass its visibility
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        vk::MemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                           .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead
+                                            | vk::AccessFlagBits::eShaderRead
+                                            | vk::AccessFlagBits::eShaderWrite},
+        {},
+        {});
+}
+
+auto gpu_culler::record_occlusion(vk::raii::CommandBuffer& command_buffer,
+                                  const uint32_t frame_index,
+                                  const depth_pyramid& pyramid,
+                                  const glm::mat4& projection_view,
+                                  const vk::Extent2D depth_extent) -> void {
+    const frame_resources& frame = frames_.at(frame_index);
+    if(frame.candidate_count > 0U) {
+        const vk::DescriptorImageInfo pyramid_info {.sampler = pyramid.sampler(),
+                                                    .imageView = pyramid.view(frame_index),
+                                                    .imageLayout = vk::ImageLayout::eGeneral};
+        driver_.device().updateDescriptorSets(
+            vk::WriteDescriptorSet {.dstSet = *pyramid_sets_[frame_index],
+                                    .dstBinding = 0U,
+                                    .dstArrayElement = 0U,
+                                    .descriptorCount = 1U,
+                                    .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+                                    .pImageInfo = &pyramid_info},
+            {});
+
+        const occlusion_push_constants push_data {
+            .projection_view = projection_view,
+            .depth_size = {depth_extent.width, depth_extent.height},
+            .candidate_count = frame.candidate_count,
+            .batch_count = frame.batch_count,
+            .level_count = pyramid.level_count(frame_index)};
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute,
+                                    occlusion_pipeline_.vk_pipeline());
+        command_buffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute,
+            *occlusion_pipeline_layout_,
+            0U,
+            {*descriptor_sets_[frame_index], *pyramid_sets_[frame_index]},
+            {});
+        command_buffer.pushConstants<occlusion_push_constants>(
+            *occlusion_pipeline_layout_, vk::ShaderStageFlagBits::eCompute, 0U, push_data);
+        command_buffer.dispatch((frame.candidate_count + WORKGROUP_SIZE - 1U) / WORKGROUP_SIZE,
+                                1U,
+                                1U);
+    }
+
+    // the indirect draws of the second pass read what it wrote
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eDrawIndirect,
+        {},
+        vk::MemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                           .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead},
+        {},
+        {});
+}
+
+auto gpu_culler::create_descriptor_set_layout() -> vk::raii::DescriptorSetLayout {
+    std::array<vk::DescriptorSetLayoutBinding, BINDING_COUNT> bindings {};
+    for(uint32_t binding = 0U; binding < BINDING_COUNT; ++binding)
+        bindings[binding] =
+            vk::DescriptorSetLayoutBinding {.binding = binding,
+                                            .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                            .descriptorCount = 1U,
+                                            .stageFlags = vk::ShaderStageFlagBits::eCompute};
+    return vk::raii::DescriptorSetLayout {
+        driver_.device(),
+        vk::DescriptorSetLayoutCreateInfo {.bindingCount = BINDING_COUNT,
+                                           .pBindings = bindings.data()}};
+}
+
+auto gpu_culler::create_pyramid_set_layout() -> vk::raii::DescriptorSetLayout {
+    const vk::DescriptorSetLayoutBinding binding {
+        .binding = 0U,
+        .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+        .descriptorCount = 1U,
+        .stageFlags = vk::ShaderStageFlagBits::eCompute};
+    return vk::raii::DescriptorSetLayout {
+        driver_.device(),
+        vk::DescriptorSetLayoutCreateInfo {.bindingCount = 1U, .pBindings = &binding}};
+}
+
+auto gpu_culler::create_pipeline_layout() -> vk::raii::PipelineLayout {
+    const vk::PushConstantRange pushconstant_range {.stageFlags = vk::ShaderStageFlagBits::eCompute,
+                                                    .offset = 0U,
+                                                    .size = sizeof(push_constants)};
+    const vk::PipelineLayoutCreateInfo pipeline_layout_info {
+        .setLayoutCount = 1U,
+        .pSetLayouts = &*descriptor_set_layout_,
+        .pushConstantRangeCount = 1U,
+        .pPushConstantRanges = &pushconstant_range};
+    return vk::raii::PipelineLayout {driver_.device(), pipeline_layout_info};
+}
+
+auto gpu_culler::create_occlusion_pipeline_layout() -> vk::raii::PipelineLayout {
+    const vk::PushConstantRange pushconstant_range {.stageFlags = vk::ShaderStageFlagBits::eCompute,
+                                                    .offset = 0U,
+                                                    .size = sizeof(occlusion_push_constants)};
+    const std::array<vk::DescriptorSetLayout, 2U> set_layouts {*descriptor_set_layout_,
+                                                                *pyramid_set_layout_};
+    const vk::PipelineLayoutCreateInfo pipeline_layout_info {
+        .setLayoutCount = static_cast<uint32_t>(set_layouts.size()),
+        .pSetLayouts = set_layouts.data(),
+        .pushConstantRangeCount = 1U,
+        .pPushConstantRanges = &pushconstant_range};
+    return vk::raii::PipelineLayout {driver_.device(), pipeline_layout_info};
+}
+
+auto gpu_culler::create_descriptor_pool() -> vk::raii::DescriptorPool {
+    const std::array<vk::DescriptorPoolSize, 2U> pool_sizes {
+        vk::DescriptorPoolSize {.type = vk::DescriptorType::eStorageBuffer,
+                                .descriptorCount =
+                                    BINDING_COUNT * swapchain::MAX_FRAMES_IN_FLIGHT},
+        vk::DescriptorPoolSize {.type = vk::DescriptorType::eCombinedImageSampler,
+                                .descriptorCount = swapchain::MAX_FRAMES_IN_FLIGHT}};
+    // the sets free themselves on destruction
+    return vk::raii::DescriptorPool {
+        driver_.device(),
+        vk::DescriptorPoolCreateInfo {
+            .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+            .maxSets = 2U * swapchain::MAX_FRAMES_IN_FLIGHT,
+            .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+            .pPoolSizes = pool_sizes.data()}};
+}
+
+auto gpu_culler::allocate_descriptor_sets(const vk::DescriptorSetLayout layout)
+    -> vk::raii::DescriptorSets {
+    std::array<vk::DescriptorSetLayout, swapchain::MAX_FRAMES_IN_FLIGHT> layouts {};
+    layouts.fill(layout);
+    return vk::raii::DescriptorSets {
+        driver_.device(),
+        vk::DescriptorSetAllocateInfo {.descriptorPool = *descriptor_pool_,
+                                       .descriptorSetCount = swapchain::MAX_FRAMES_IN_FLIGHT,
+                                       .pSetLayouts = layouts.data()}};
+}
+
+auto gpu_culler::reserve(std::optional<culling_buffer>& buffer,
+                         const vk::DeviceSize size,
+                         const vk::BufferUsageFlags usage,
+                         const vk::MemoryPropertyFlags properties,
+                         const vk::DeviceSize min_size) -> culling_buffer& {
+    if(!buffer || (buffer->size < size)) {
+        // the frame's fence was waited on, the buffer it used last time is no longer read
+        const vk::DeviceSize new_size =
+            std::max({size, min_size, buffer ? buffer->size * 2U : vk::DeviceSize {0U}});
+        vk::raii::Buffer created = driver_.create_buffer(new_size, usage);
+        memory_allocation memory = driver_.bind_memory_to_buffer(created, properties);
+        buffer.reset();
+        buffer.emplace(culling_buffer {
+            .buffer = std::move(created), .memory = std::move(memory), .size = new_size});
+    }
+    return *buffer;
+}
+
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/range_allocator.hpp"
+
+namespace arcticvox::graphics {
+
+namespace {
+auto pool_index(const uint32_t memory_type, const memory_allocator::resource_kind kind)
+    -> std::size_t {
+    return static_cast<std::size_t>(memory_type) * 2U + static_cast<std::size_t>(kind);
+}
+}
+
+memory_allocation::memory_allocation(memory_allocation&& other) noexcept :
+    allocator_(std::exchange(other.allocator_, nullptr)),
+    pool_(other.pool_),
+    memory_(other.memory_),
+    offset_(other.offset_),
+    size_(other.size_),
+    mapped_(std::exchange(other.mapped_, nullptr)) { }
+
+memory_allocation::~memory_allocation() {
+    reset();
+}
+
+memory_allocation& memory_allocation::operator=(memory_allocation&& other) noexcept {
+    if(this != &other) {
+        reset();
+        allocator_ = std::exchange(other.allocator_, nullptr);
+        pool_ = other.pool_;
+        memory_ = other.memory_;
+        offset_ = other.offset_;
+        size_ = other.size_;
+        mapped_ = std::exchange(other.mapped_, nullptr);
+    }
+    return *this;
+}
+
+void memory_allocation::reset() {
+    if(allocator_)
+        allocator_->free(*this);
+    allocator_ = nullptr;
+    mapped_ = nullptr;
+}
+
+memory_allocator::memory_allocator(gpu& gpu,
+                                   vk::raii::Device& device,
+                                   const bool memory_budget,
+                                   const vk::DeviceSize block_size) :
+    gpu_(gpu),
+    device_(device),
+    block_size_(block_size),
+    memory_budget_(memory_budget),
+    memory_properties_(gpu.physical_device().getMemoryProperties()),
+    heap_usage_(memory_properties_.memoryHeapCount, 0U) {
+    pools_.resize(static_cast<std::size_t>(memory_properties_.memoryTypeCount) * 2U);
+    for(uint32_t type = 0U; type < memory_properties_.memoryTypeCount; ++type) {
+        pools_[pool_index(type, resource_kind::linear)].memory_type = type;
+        pools_[pool_index(type, resource_kind::optimal)].memory_type = type;
+    }
+}
+
+auto memory_allocator::allocate(const vk::MemoryRequirements& requirements,
+                                const vk::MemoryPropertyFlags properties,
+                                const resource_kind kind) -> memory_allocation {
+    const uint32_t memory_type = gpu_.find_memory_type(requirements.memoryTypeBits, properties);
+    const std::size_t target_index = pool_index(memory_type, kind);
+
+    std::lock_guard lock {mutex_};
+    pool& target = pools_.at(target_index);
+
+    block* source = nullptr;
+    std::optional<vk::DeviceSize> offset;
+    const bool dedicated = requirements.size > block_size_ / 2U;
+    if(!dedicated) {
+        for(const std::unique_ptr<block>& candidate: target.blocks) {
+            offset = candidate->ranges.allocate(requirements.size, requirements.alignment);
+            if(offset) {
+                source = candidate.get();
+                break;
+            }
+        }
+    }
+
+    if(!source) {
+        // large resources get a block of their own instead of fragmenting the shared ones
+        const vk::DeviceSize block_size = dedicated ? requirements.size : block_size_;
+        const uint32_t heap = heap_of(target);
+        heap_budget budget = query_heap_budget(heap);
+        if(budget.usage + block_size > budget.budget) {
+            release_empty_blocks(heap);
+            budget = query_heap_budget(heap);
+            if(budget.usage + block_size > budget.budget)
+                spdlog::warn("Memory heap {} exceeds its budget, {} of {} bytes in use",
+                             heap,
+                             budget.usage + block_size,
+                             budget.budget);
+        }
+        source = &create_block(target, block_size);
+        offset = source->ranges.allocate(requirements.size, requirements.alignment);
+        if(!offset)
+            throw std::runtime_error("Failed to sub-allocate from a new memory block");
+    }
+
+    ++source->allocation_count;
+    ++allocation_count_;
+    allocated_bytes_ += requirements.size;
+
+    memory_allocation allocation {};
+    allocation.allocator_ = this;
+    allocation.pool_ = target_index;
+    allocation.memory_ = *source->memory;
+    allocation.offset_ = *offset;
+    allocation.size_ = requirements.size;
+    allocation.mapped_ = source->mapped ? source->mapped + *offset : nullptr;
+    return allocation;
+}
+
+auto memory_allocator::get_statistics() const -> statistics {
+    std::lock_guard lock {mutex_};
+    statistics stats {.allocation_count = allocation_count_, .allocated_bytes = allocated_bytes_};
+    for(const pool& source: pools_) {
+        stats.block_count += source.blocks.size();
+        for(const std::unique_ptr<block>& candidate: source.blocks)
+            stats.reserved_bytes += candidate->size;
+    }
+    return stats;
+}
+
+auto memory_allocator::get_heap_budgets() const -> std::vector<heap_budget> {
+    std::lock_guard lock {mutex_};
+    std::vector<heap_budget> budgets;
+    for(uint32_t heap = 0U; heap < memory_properties_.memoryHeapCount; ++heap)
+        budgets.push_back(query_heap_budget(heap));
+    return budgets;
+}
+
+auto memory_allocator::device_local_budget() const -> vk::DeviceSize {
+    std::lock_guard lock {mutex_};
+    vk::DeviceSize largest = 0U;
+    vk::DeviceSize budget = 0U;
+    for(uint32_t heap = 0U; heap < memory_properties_.memoryHeapCount; ++heap) {
+        const vk::MemoryHeap& candidate = memory_properties_.memoryHeaps[heap];
+        if((candidate.flags & vk::MemoryHeapFlagBits::eDeviceLocal) && (candidate.size > largest)) {
+            largest = candidate.size;
+            budget = query_heap_budget(heap).budget;
+        }
+    }
+    return budget;
+}
+
+auto memory_allocator::free(memory_allocation& allocation) -> void {
+    std::lock_guard lock {mutex_};
+    pool& source = pools_.at(allocation.pool_);
+    const auto owner = std::find_if(
+        source.blocks.begin(), source.blocks.end(), [&](const std::unique_ptr<block>& candidate) {
+            return *candidate->memory == allocation.memory_;
+        });
+    if(owner == source.blocks.end()) {
+        spdlog::error("Freed memory allocation does not belong to the allocator");
+        return;
+    }
+    block& target = **owner;
+
+    target.ranges.free(allocation.offset_, allocation.size_);
+
+    --target.allocation_count;
+    --allocation_count_;
+    allocated_bytes_ -= allocation.size_;
+
+    // keep one empty shared block per pool around, a recreated resource would need it right away
+    if((target.allocation_count == 0U)
+       && ((target.size != block_size_) || (source.blocks.size() > 1U))) {
+        heap_usage_[heap_of(source)] -= target.size;
+        source.blocks.erase(owner);
+    }
+}
+
+auto memory_allocator::create_block(pool& target, const vk::DeviceSize size) -> block& {
+    const vk::MemoryAllocateInfo allocate_info {.allocationSize = size,
+                                                .memoryTypeIndex = target.memory_type};
+    vk::raii::DeviceMemory memory {device_, allocate_info};
+
+    std::byte* mapped = nullptr;
+    if(memory_properties_.memoryTypes[target.memory_type].propertyFlags
+       & vk::MemoryPropertyFlagBits::eHostVisible)
+        mapped = static_cast<std::byte*>(memory.mapMemory(0U, VK_WHOLE_SIZE));
+
+    target.blocks.push_back(std::make_unique<block>(block {.memory = std::move(memory),
+                                                           .size = size,
+                                                           .mapped = mapped,
+                                                           .ranges = range_allocator {size}}));
+    heap_usage_[heap_of(target)] += size;
+    spdlog::debug("Allocated {} byte memory block of type {}", size, target.memory_type);
+    return *target.blocks.back();
+}
+
+auto memory_allocator::query_heap_budget(const uint32_t heap) const -> heap_budget {
+    if(memory_budget_) {
+        // includes the memory of resources not created through the allocator
+        const auto chain = gpu_.physical_device()
+                               .getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2,
+                                                     vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+        const auto& properties = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+        return heap_budget {.budget = properties.heapBudget[heap],
+                            .usage = properties.heapUsage[heap]};
+    }
+    const vk::DeviceSize size = memory_properties_.memoryHeaps[heap].size;
+    return heap_budget {
+        .budget = static_cast<vk::DeviceSize>(static_cast<float>(size) * FALLBACK_BUDGET_SHARE),
+        .usage = heap_usage_[heap]};
+}
+
+auto memory_allocator::release_empty_blocks(const uint32_t heap) -> void {
+    for(pool& source: pools_) {
+        if(heap_of(source) != heap)
+            continue;
+        std::erase_if(source.blocks, [&](const std::unique_ptr<block>& candidate) {
+            if(candidate->allocation_count > 0U)
+                return false;
+            heap_usage_[heap] -= candidate->size;
+            return true;
+        });
+    }
+}
+
+}
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <spdlog/spdlog.h>
+
+#include "arcticvox/components/model.hpp"
+#include "arcticvox/components/model_handle.hpp"
+#include "arcticvox/components/vertex.hpp"
+#include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/geometry_arena.hpp"
+#include "arcticvox/graphics/model_streamer.hpp"
+#include "arcticvox/graphics/swapchain.hpp"
+#include "arcticvox/io/model_builder.hpp"
+
+namespace arcticvox::graphics {
+
+// evicted models must not be read by any frame in flight
+static_assert(model_streamer::EVICTION_FRAMES > swapchain::MAX_FRAMES_IN_FLIGHT);
+
+namespace {
+io::model_builder make_placeholder_cube() {
+    io::model_builder builder {};
+    for(uint32_t corner = 0U; corner < 8U; ++corner) {
+        components::vertex vtx {};
+        vtx.position.pos = glm::vec3 {(corner & 1U) ? 0.5f : -0.5f,
+                                      (corner & 2U) ? 0.5f : -0.5f,
+                                      (corner & 4U) ? 0.5f : -0.5f};
+        vtx.normal = vtx.position.pos * 2.0f;
+        vtx.colour.col = glm::vec4 {0.5f, 0.5f, 0.5f, 1.0f};
+        builder.vertices.push_back(vtx);
+        builder.bounds.extend(vtx.position.pos);
+    }
+
+    // two triangles per face, corners indexed by their x, y and z bits
+    constexpr std::array<uint32_t, 36U> cube_indices {0U, 2U, 1U, 1U, 2U, 3U, 4U, 5U, 6U,
+                                                      5U, 7U, 6U, 0U, 1U, 4U, 1U, 5U, 4U,
+                                                      2U, 6U, 3U, 3U, 6U, 7U, 0U, 4U, 2U,
+                                                      2U, 4U, 6U, 1U, 3U, 5U, 3U, 7U, 5U};
+    builder.indices.assign(cube_indices.cbegin(), cube_indices.cend());
+    return builder;
+}
+}
+
+model_streamer::model_streamer(gpu_driver& driver, const std::size_t thread_count) :
+    driver_(driver), workers_(thread_count) { }
+
+components::model_handle model_streamer::load(const std::filesystem::path& filepath,
+                                               io::model_builder settings) {
+    auto state = std::make_shared<components::model_handle::shared_state>();
+    {
+        std::lock_guard lock {pending_mutex_};
+        ++pending_count_;
+    }
+
+    // the settings without any data, to reimport the model with once it was evicted
+    io::model_builder reimport = settings;
+    workers_.submit([this, state, filepath, reimport, builder = std::move(settings)]() mutable {
+        // the import itself is parallelised on the same pool
+        builder.workers = &workers_;
+        try {
+            if(builder.load_model(filepath)) {
+                state->loaded_model = std::make_shared<components::model>(driver_, builder);
+                {
+                    std::lock_guard lock {tracked_mutex_};
+                    tracked_.push_back(tracked_model {.model = state->loaded_model,
+                                                      .filepath = filepath,
+                                                      .settings = std::move(reimport),
+                                                      .last_drawn = frame_.load()});
+                }
+                state->state.store(components::model_handle::load_state::resident,
+                                   std::memory_order_release);
+            } else {
+                spdlog::warn("Unable to load model {}", filepath.string());
+                state->state.store(components::model_handle::load_state::failed,
+                                   std::memory_order_release);
+            }
+        } catch(const std::exception& e) {
+            spdlog::error("Loading model {} failed: {}", filepath.string(), e.what());
+            state->state.store(components::model_handle::load_state::failed,
+                               std::memory_order_release);
+        }
+        finish_load();
+    });
+
+    return components::model_handle {std::move(state)};
+}
+
+std::shared_ptr<components::model> model_streamer::placeholder() {
+    std::lock_guard lock {placeholder_mutex_};
+    if(!placeholder_)
+        placeholder_ = std::make_shared<components::model>(driver_, make_placeholder_cube());
+    return placeholder_;
+}
+
+void model_streamer::wait_idle() {
+    std::unique_lock lock {pending_mutex_};
+    idle_.wait(lock, [this]() { return pending_count_ == 0U; });
+}
+
+void model_streamer::update_residency(const uint64_t frame) {
+    frame_.store(frame);
+    geometry_arena& arena = driver_.geometry();
+    // a model did not fit, make room for more than the usual margin
+    const float usage_target = arena.take_allocation_failure() ? RESIDENCY_TARGET * 0.5f
+                                                               : RESIDENCY_TARGET;
+
+    std::lock_guard lock {tracked_mutex_};
+    std::erase_if(tracked_, [](const tracked_model& tracked) { return tracked.model.expired(); });
+
+    std::vector<std::pair<uint64_t, std::shared_ptr<components::model>>> idle;
+    for(tracked_model& tracked: tracked_) {
+        std::shared_ptr<components::model> target_model = tracked.model.lock();
+        if(!target_model)
+            continue;
+        if(target_model->take_drawn())
+            tracked.last_drawn = frame;
+        if(target_model->take_residency_request() && (frame >= tracked.next_restore)
+           && target_model->begin_restore()) {
+            // counts as drawn, so the model is not evicted again before its first draw
+            tracked.last_drawn = frame;
+            tracked.next_restore = frame + EVICTION_FRAMES;
+            restore(std::move(target_model), tracked);
+            continue;
+        }
+        if(target_model->resident() && (frame - tracked.last_drawn >= EVICTION_FRAMES))
+            idle.emplace_back(tracked.last_drawn, std::move(target_model));
+    }
+
+    if(idle.empty() || (arena.usage() <= usage_target))
+        return;
+    std::sort(idle.begin(), idle.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    std::size_t evicted = 0U;
+    for(const auto& [last_drawn, candidate]: idle) {
+        if(arena.usage() <= usage_target)
+            break;
+        candidate->evict();
+        ++evicted;
+    }
+    spdlog::debug("Evicted {} models, geometry arena usage {:.2f}", evicted, arena.usage());
+}
+
+void model_streamer::restore(std::shared_ptr<components::model> target,
+                             const tracked_model& tracked) {
+    {
+        std::lock_guard lock {pending_mutex_};
+        ++pending_count_;
+    }
+
+    workers_.submit([this, target = std::move(target), filepath = tracked.filepath,
+                     builder = tracked.settings]() mutable {
+        builder.workers = &workers_;
+        try {
+            if(builder.load_model(filepath)) {
+                target->restore(builder);
+            } else {
+                spdlog::warn("Unable to reload evicted model {}", filepath.string());
+                target->cancel_restore();
+            }
+        } catch(const std::exception& e) {
+            spdlog::error("Restoring model {} failed: {}", filepath.string(), e.what());
+            // a failed import leaves the model restoring, it is requested again once drawn
+            target->cancel_restore();
+        }
+        finish_load();
+    });
+}
+
+void model_streamer::finish_load() {
+    {
+        std::lock_guard lock {pending_mutex_};
+        --pending_count_;
+    }
+    idle_.notify_all();
+}
+
+}
@@ -10,6 +10,21 @@
 
 namespace arcticvox::graphics {
 
+namespace {
+/**
+ * @brief Creates a vulkan shader module with the provided shader code
+ */
+auto load_shader_module(vk::raii::Device& device, const std::vector<char>& shader_code)
+    -> vk::raii::ShaderModule {
+    const std::vector<uint32_t> shader_code_converted =
+        io::shader_loader::shader_byte_to_u32(shader_code);
+
+    vk::ShaderModuleCreateInfo shader_module_create_info {
+        .flags {}, .codeSize = shader_code.size(), .pCode = shader_code_converted.data()};
+    return vk::raii::ShaderModule {device, shader_module_create_info};
+}
+}
+
 pipeline::pipeline(gpu& device,
                    gpu_driver& driver,
                    const std::vector<char>& vertex_shader,
@@ -88,7 +103,9 @@ auto pipeline::get_default_pipeline_config() -> pipeline_config_info {
         .dynamic_state_info = {
             .dynamicStateCount = dynamic_states_enabled.size(),
             .pDynamicStates = dynamic_states_enabled.data(),
-        }};
+        },
+        .binding_descriptions = components::vertex::get_binding_description(),
+        .attribute_descriptions = components::vertex::get_attribute_description()};
 
     return config_info;
 }
@@ -104,16 +121,12 @@ auto pipeline::create_pipeline(const pipeline_config_info& config) -> vk::raii::
                                            .module = fragment_shader_module_,
                                            .pName = "main"}};
 
-    std::vector<vk::VertexInputAttributeDescription> attribute_descriptions = {
-        components::vertex::get_attribute_description()};
-    std::vector<vk::VertexInputBindingDescription> binding_description = {
-        components::vertex::get_binding_description()};
-
     vk::PipelineVertexInputStateCreateInfo vtx_input_create_info {
-        .vertexBindingDescriptionCount = static_cast<uint32_t>(binding_description.size()),
-        .pVertexBindingDescriptions = binding_description.data(),
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size()),
-        .pVertexAttributeDescriptions = attribute_descriptions.data()};
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(config.binding_descriptions.size()),
+        .pVertexBindingDescriptions = config.binding_descriptions.data(),
+        .vertexAttributeDescriptionCount =
+            static_cast<uint32_t>(config.attribute_descriptions.size()),
+        .pVertexAttributeDescriptions = config.attribute_descriptions.data()};
 
     vk::GraphicsPipelineCreateInfo pipeline_create_info {
         .flags = {},
@@ -138,11 +151,27 @@ auto pipeline::create_pipeline(const pipeline_config_info& config) -> vk::raii::
 
 auto pipeline::create_shader_module(const std::vector<char>& shader_code)
     -> vk::raii::ShaderModule {
-    const std::vector<uint32_t> shader_code_converted =
-        io::shader_loader::shader_byte_to_u32(shader_code);
+    return load_shader_module(driver_.device(), shader_code);
+}
 
-    vk::ShaderModuleCreateInfo shader_module_create_info {
-        .flags {}, .codeSize = shader_code.size(), .pCode = shader_code_converted.data()};
-    return vk::raii::ShaderModule {driver_.device(), shader_module_create_info};
+compute_pipeline::compute_pipeline(gpu_driver& driver,
+                                   const std::vector<char>& compute_shader,
+                                   const vk::PipelineLayout pipeline_layout) :
+    driver_(driver),
+    compute_shader_module_(load_shader_module(driver_.device(), compute_shader)),
+    pipeline_(create_pipeline(pipeline_layout)) { }
+
+auto compute_pipeline::create_pipeline(const vk::PipelineLayout pipeline_layout)
+    -> vk::raii::Pipeline {
+    const vk::ComputePipelineCreateInfo pipeline_create_info {
+        .flags = {},
+        .stage = vk::PipelineShaderStageCreateInfo {.flags = {},
+                                                    .stage = vk::ShaderStageFlagBits::eCompute,
+                                                    .module = compute_shader_module_,
+                                                    .pName = "main"},
+        .layout = pipeline_layout,
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex = -1};
+    return vk::raii::Pipeline {driver_.device(), nullptr, pipeline_create_info};
 }
 }
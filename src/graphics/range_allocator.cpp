@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
+#include <vulkan/vulkan.hpp>
+
+#include "arcticvox/graphics/range_allocator.hpp"
+
+namespace arcticvox::graphics {
+
+namespace {
+auto align_up(const vk::DeviceSize value, const vk::DeviceSize alignment) -> vk::DeviceSize {
+    return (value + alignment - 1U) / alignment * alignment;
+}
+}
+
+range_allocator::range_allocator(const vk::DeviceSize size) :
+    size_(size),
+    free_bytes_(size),
+    free_ {{0U, size}} { }
+
+auto range_allocator::allocate(const vk::DeviceSize size, vk::DeviceSize alignment)
+    -> std::optional<vk::DeviceSize> {
+    alignment = std::max<vk::DeviceSize>(alignment, 1U);
+
+    // best fit, the smallest free range the aligned request fits into
+    auto best = free_.end();
+    for(auto range = free_.begin(); range != free_.end(); ++range) {
+        const vk::DeviceSize aligned = align_up(range->first, alignment);
+        if((aligned + size <= range->first + range->second)
+           && ((best == free_.end()) || (range->second < best->second)))
+            best = range;
+    }
+    if(best == free_.end())
+        return std::nullopt;
+
+    const vk::DeviceSize range_begin = best->first;
+    const vk::DeviceSize range_end = best->first + best->second;
+    const vk::DeviceSize aligned = align_up(range_begin, alignment);
+    free_.erase(best);
+    if(aligned > range_begin)
+        free_.emplace(range_begin, aligned - range_begin);
+    if(aligned + size < range_end)
+        free_.emplace(aligned + size, range_end - aligned - size);
+    free_bytes_ -= size;
+    return aligned;
+}
+
+auto range_allocator::free(const vk::DeviceSize offset, const vk::DeviceSize size) -> void {
+    // merge the range with its free neighbours
+    vk::DeviceSize begin = offset;
+    vk::DeviceSize end = offset + size;
+    auto next = free_.lower_bound(begin);
+    if(next != free_.begin()) {
+        const auto previous = std::prev(next);
+        if(previous->first + previous->second == begin) {
+            begin = previous->first;
+            free_.erase(previous);
+        }
+    }
+    if((next != free_.end()) && (next->first == end)) {
+        end += next->second;
+        free_.erase(next);
+    }
+    free_.emplace(begin, end - begin);
+    free_bytes_ += size;
+}
+
+auto range_allocator::largest_free_range() const -> vk::DeviceSize {
+    vk::DeviceSize largest = 0U;
+    for(const auto& [offset, size]: free_)
+        largest = std::max(largest, size);
+    return largest;
+}
+
+}
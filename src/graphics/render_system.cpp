@@ -1,62 +1,816 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
 #include <vulkan/vulkan_raii.hpp>
 
+#include <glm/geometric.hpp>
 #include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <spdlog/spdlog.h>
 
+#include "arcticvox/components/camera_uniform.hpp"
+#include "arcticvox/components/compact_vertex.hpp"
 #include "arcticvox/components/gameobject.hpp"
-#include "arcticvox/components/push_constant.hpp"
+#include "arcticvox/components/instance.hpp"
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/submesh.hpp"
+#include "arcticvox/components/transform_store.hpp"
+#include "arcticvox/components/vertex.hpp"
+#include "arcticvox/graphics/bounding_spheres.hpp"
 #include "arcticvox/graphics/camera.hpp"
+#include "arcticvox/graphics/depth_pyramid.hpp"
 #include "arcticvox/graphics/driver.hpp"
+#include "arcticvox/graphics/frustum.hpp"
+#include "arcticvox/graphics/geometry_arena.hpp"
 #include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/gpu_culler.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
 #include "arcticvox/graphics/pipeline.hpp"
 #include "arcticvox/graphics/render_system.hpp"
 
 namespace arcticvox::graphics {
 
-render_system::render_system(gpu& gpu, gpu_driver& driver, vk::raii::RenderPass& renderpass) :
+namespace {
+//! Keeps the projected error finite for submeshes around the camera
+constexpr float MIN_LOD_DISTANCE = 1e-3f;
+//! Largest material and model rank the draw keys' fields hold, larger ones share it
+constexpr uint32_t MAX_SORT_MATERIAL = (1U << 12U) - 1U;
+constexpr uint32_t MAX_SORT_MODEL_RANK = (1U << 24U) - 1U;
+
+/**
+ * @brief Returns the largest factor the matrix scales a length by, assuming no shear
+ */
+float max_scale(const glm::mat4& matrix) {
+    return std::max({glm::length(glm::vec3 {matrix[0]}),
+                     glm::length(glm::vec3 {matrix[1]}),
+                     glm::length(glm::vec3 {matrix[2]})});
+}
+
+/**
+ * @brief Culls the meshlet against the world space frustum and its normal cone
+ *
+ * @param cluster The meshlet, in the space of the mesh's vertices
+ * @param model_matrix Transforms the mesh's vertices into world space
+ * @param scale The largest scale factor of model_matrix
+ * @param view_frustum The camera's frustum in world space
+ * @param camera_position The camera's position in world space
+ * @param cone_culling Whether back facing meshlets are culled
+ *
+ * @details The normal cone is transformed as a direction, which is exact for rotations and uniform
+ * scales. Non uniform scales bend the normals, keep them small on cone culled models.
+ */
+bool meshlet_visible(const components::meshlet& cluster,
+                     const glm::mat4& model_matrix,
+                     const float scale,
+                     const frustum& view_frustum,
+                     const glm::vec3& camera_position,
+                     const bool cone_culling) {
+    const glm::vec3 center {model_matrix * glm::vec4 {cluster.center, 1.0f}};
+    const float radius = cluster.radius * scale;
+    if(!view_frustum.intersects_sphere(center, radius))
+        return false;
+    if(!cone_culling || (cluster.cone_cutoff >= 1.0f))
+        return true;
+
+    const glm::vec3 axis =
+        glm::normalize(glm::vec3 {model_matrix * glm::vec4 {cluster.cone_axis, 0.0f}});
+    const glm::vec3 to_cluster = center - camera_position;
+    return glm::dot(to_cluster, axis) < cluster.cone_cutoff * glm::length(to_cluster) + radius;
+}
+
+/**
+ * @brief Builds the key ordering a draw by pipeline, index type, material, depth and model
+ *
+ * @details The key is laid out from the most significant bit as 2 bits vertex format, 2 bits
+ * index type, 12 bits material, 24 bits depth and 24 bits model rank. All models share the geometry
+ * arena's buffers, so the model does not change any binding and only orders draws of equal depth.
+ * The depth is the top of the float's bits, which order like the values for positive floats.
+ */
+uint64_t draw_key(const components::vertex_format format,
+                  const std::optional<vk::IndexType> index_type,
+                  const uint32_t material,
+                  const float depth,
+                  const uint32_t model_rank) {
+    uint64_t index_code = 0U;
+    if(index_type)
+        index_code = (*index_type == vk::IndexType::eUint16)   ? 1U
+                     : (*index_type == vk::IndexType::eUint32) ? 2U
+                                                               : 3U;
+    // draws reaching behind the camera, or without bounds, are drawn first
+    const float clamped_depth = (depth > 0.0f) ? depth : 0.0f;
+    return (static_cast<uint64_t>(format) << 62U) | (index_code << 60U)
+           | (static_cast<uint64_t>(std::min(material, MAX_SORT_MATERIAL)) << 48U)
+           | (static_cast<uint64_t>(std::bit_cast<uint32_t>(clamped_depth) >> 8U) << 24U)
+           | std::min(model_rank, MAX_SORT_MODEL_RANK);
+}
+
+/**
+ * @brief Returns the coarsest level of the submesh whose error stays below the threshold on screen
+ *
+ * @param mesh The submesh to draw
+ * @param model_view Transforms the submesh's vertices into view space
+ * @param pixels_per_unit Projected size of one view space unit at distance 1, in pixels
+ */
+std::size_t select_lod(const components::submesh& mesh,
+                       const glm::mat4& model_view,
+                       const float pixels_per_unit) {
+    if(mesh.lod_count == 0U)
+        return 0U;
+
+    // errors are measured before the transform, scale them by its largest axis
+    const float scale = max_scale(model_view);
+    const glm::vec3 center {model_view * glm::vec4 {mesh.bounds.center(), 1.0f}};
+    const float radius = glm::length(mesh.bounds.extent()) * 0.5f * scale;
+    const float distance = std::max(glm::length(center) - radius, MIN_LOD_DISTANCE);
+    const float error_scale = scale * pixels_per_unit / distance;
+
+    for(std::size_t level = mesh.lod_count; level > 0U; --level) {
+        if(mesh.lods[level - 1U].error * error_scale <= render_system::LOD_ERROR_THRESHOLD)
+            return level;
+    }
+    return 0U;
+}
+}
+
+render_system::render_system(gpu& gpu,
+                             gpu_driver& driver,
+                             vk::raii::RenderPass& renderpass,
+                             command_buffer_manager& command_buffers,
+                             components::transform_store& transforms) :
     gpu_(gpu),
     driver_(driver),
+    command_buffers_(command_buffers),
+    transforms_(transforms),
+    camera_set_layout_(create_camera_set_layout()),
     pipeline_layout_(create_pipeline_layout()),
-    pipeline_(create_pipeline(renderpass)) { }
+    descriptor_pool_(create_descriptor_pool()),
+    camera_sets_(allocate_camera_sets()),
+    pipeline_(create_pipeline(renderpass, components::vertex_format::full)),
+    compact_pipeline_(create_pipeline(renderpass, components::vertex_format::compact)),
+    submission_(driver_.multi_draw_indirect() ? submission::indirect : submission::direct),
+    max_draw_indirect_count_(gpu_.physical_device().getProperties().limits.maxDrawIndirectCount) {
+    // the camera buffers never grow, so each frame's set is written once
+    for(uint32_t frame = 0U; frame < swapchain::MAX_FRAMES_IN_FLIGHT; ++frame) {
+        const frame_buffer& camera_buffer =
+            reserve_frame_buffer(camera_buffers_[frame],
+                                 sizeof(components::camera_uniform_data),
+                                 vk::BufferUsageFlagBits::eUniformBuffer,
+                                 0U);
+        const vk::DescriptorBufferInfo buffer_info {
+            .buffer = *camera_buffer.buffer,
+            .offset = 0U,
+            .range = sizeof(components::camera_uniform_data)};
+        driver_.device().updateDescriptorSets(
+            vk::WriteDescriptorSet {.dstSet = *camera_sets_[frame],
+                                    .dstBinding = 0U,
+                                    .dstArrayElement = 0U,
+                                    .descriptorCount = 1U,
+                                    .descriptorType = vk::DescriptorType::eUniformBuffer,
+                                    .pBufferInfo = &buffer_info},
+            {});
+    }
+}
+
+void render_system::set_submission(const submission mode) {
+    if((mode == submission::indirect) && !driver_.multi_draw_indirect()) {
+        spdlog::warn("Multi draw indirect is not supported, keeping direct submission");
+        return;
+    }
+    if((mode == submission::gpu_culled)
+       && !(driver_.multi_draw_indirect() && driver_.draw_indirect_count())) {
+        spdlog::warn("Draw indirect count is not supported, keeping the submission");
+        return;
+    }
+    if((mode == submission::parallel) && !recording_workers_)
+        recording_workers_ = std::make_unique<thread_pool>();
+    if((mode == submission::gpu_culled) && !gpu_culler_)
+        gpu_culler_ = std::make_unique<gpu_culler>(driver_);
+    submission_ = mode;
+}
+
+void render_system::set_occlusion_culling(const bool enabled) {
+    if(enabled && !depth_pyramid_)
+        depth_pyramid_ = std::make_unique<depth_pyramid>(driver_);
+    occlusion_culling_ = enabled;
+}
+
+vk::raii::DescriptorSetLayout render_system::create_camera_set_layout() {
+    const vk::DescriptorSetLayoutBinding binding {.binding = 0U,
+                                                  .descriptorType =
+                                                      vk::DescriptorType::eUniformBuffer,
+                                                  .descriptorCount = 1U,
+                                                  .stageFlags = vk::ShaderStageFlagBits::eVertex};
+    return vk::raii::DescriptorSetLayout {
+        driver_.device(),
+        vk::DescriptorSetLayoutCreateInfo {.bindingCount = 1U, .pBindings = &binding}};
+}
 
 vk::raii::PipelineLayout render_system::create_pipeline_layout() {
-    vk::PushConstantRange pushconstant_range {.stageFlags = vk::ShaderStageFlagBits::eVertex
-                                                            | vk::ShaderStageFlagBits::eFragment,
-                                              .offset = 0U,
-                                              .size = sizeof(components::push_constant_data)};
-    vk::PipelineLayoutCreateInfo pipeline_layout_info {.setLayoutCount = 0U,
-                                                       .pSetLayouts = nullptr,
-                                                       .pushConstantRangeCount = 1U,
-                                                       .pPushConstantRanges = &pushconstant_range};
+    vk::PipelineLayoutCreateInfo pipeline_layout_info {.setLayoutCount = 1U,
+                                                       .pSetLayouts = &*camera_set_layout_,
+                                                       .pushConstantRangeCount = 0U,
+                                                       .pPushConstantRanges = nullptr};
     return vk::raii::PipelineLayout {driver_.device(), pipeline_layout_info};
 }
 
-std::unique_ptr<pipeline> render_system::create_pipeline(vk::raii::RenderPass& renderpass) {
+vk::raii::DescriptorPool render_system::create_descriptor_pool() {
+    const vk::DescriptorPoolSize pool_size {.type = vk::DescriptorType::eUniformBuffer,
+                                            .descriptorCount = swapchain::MAX_FRAMES_IN_FLIGHT};
+    // the sets free themselves on destruction
+    return vk::raii::DescriptorPool {
+        driver_.device(),
+        vk::DescriptorPoolCreateInfo {
+            .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+            .maxSets = swapchain::MAX_FRAMES_IN_FLIGHT,
+            .poolSizeCount = 1U,
+            .pPoolSizes = &pool_size}};
+}
+
+vk::raii::DescriptorSets render_system::allocate_camera_sets() {
+    std::array<vk::DescriptorSetLayout, swapchain::MAX_FRAMES_IN_FLIGHT> layouts {};
+    layouts.fill(*camera_set_layout_);
+    return vk::raii::DescriptorSets {
+        driver_.device(),
+        vk::DescriptorSetAllocateInfo {.descriptorPool = *descriptor_pool_,
+                                       .descriptorSetCount =
+                                           static_cast<uint32_t>(layouts.size()),
+                                       .pSetLayouts = layouts.data()}};
+}
+
+std::unique_ptr<pipeline> render_system::create_pipeline(vk::raii::RenderPass& renderpass,
+                                                         const components::vertex_format format) {
     pipeline_config_info pipeline_config = pipeline::get_default_pipeline_config();
 
     pipeline_config.render_pass = *renderpass;
     pipeline_config.pipeline_layout = *pipeline_layout_;
-    return std::make_unique<pipeline>(gpu_, driver_, vtx_shader_, fgt_shader_, pipeline_config);
+    const bool compact = format == components::vertex_format::compact;
+    pipeline_config.binding_descriptions =
+        compact ? components::compact_vertex::get_binding_description()
+                : components::vertex::get_binding_description();
+    pipeline_config.attribute_descriptions =
+        compact ? components::compact_vertex::get_attribute_description()
+                : components::vertex::get_attribute_description();
+
+    // per instance data follows the vertices of either format
+    for(const vk::VertexInputBindingDescription& binding:
+        components::instance::get_binding_description())
+        pipeline_config.binding_descriptions.push_back(binding);
+    for(const vk::VertexInputAttributeDescription& attribute:
+        components::instance::get_attribute_description())
+        pipeline_config.attribute_descriptions.push_back(attribute);
+
+    return std::make_unique<pipeline>(gpu_,
+                                      driver_,
+                                      compact ? compact_vtx_shader_ : vtx_shader_,
+                                      fgt_shader_,
+                                      pipeline_config);
 }
 
 void render_system::render_gameobjects(vk::raii::CommandBuffer& command_buffer,
                                        std::vector<components::gameobject>& gameobjects,
-                                       camera& cam) {
-    command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline_->vk_pipeline());
-
-    const glm::mat4 projection_view = cam.projection_matrix() * cam.view_matrix();
-
-    for(components::gameobject& obj: gameobjects) {
-        components::push_constant_data push_data {
-            .transform = projection_view * obj.transform.mat4(),
-            .colour = obj.colour,
-        };
-        command_buffer.pushConstants<components::push_constant_data>(
-            *pipeline_layout_,
-            vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
-            0U,
-            push_data);
-        obj.model->bind(command_buffer);
-        obj.model->draw(command_buffer);
+                                       camera& cam,
+                                       const vk::Extent2D extent,
+                                       const uint32_t frame_index,
+                                       const vk::CommandBufferInheritanceInfo& inheritance) {
+    const glm::mat4 projection = cam.projection_matrix();
+    const glm::mat4 view = cam.view_matrix();
+    const glm::mat4 projection_view = projection * view;
+    const float pixels_per_unit =
+        std::abs(projection[1][1]) * 0.5f * static_cast<float>(extent.height);
+    const frustum view_frustum = frustum::from_matrix(projection_view);
+    const glm::vec3 camera_position {glm::inverse(view)[3]};
+
+    // the frame's fence was waited on, the device no longer reads the frame's camera
+    *reinterpret_cast<components::camera_uniform_data*>(
+        camera_buffers_.at(frame_index)->memory.mapped()) =
+        components::camera_uniform_data {
+            .view = view, .projection = projection, .projection_view = projection_view};
+    if(submission_ == submission::gpu_culled) {
+        // cull_gameobjects() wrote the frame's instances and left the batches of its commands
+        if(instance_buffers_.at(frame_index)) {
+            bind_frame_state(command_buffer, *instance_buffers_[frame_index]->buffer, frame_index);
+            record_culled_draws(command_buffer, frame_index, false);
+        }
+        return;
+    }
+
+    // objects sharing a model are drawn together as instances, they are sorted by their model
+    frame_buffer& instances = reserve_instances(frame_index, sort_by_model(gameobjects));
+    auto* const instance_data = reinterpret_cast<components::instance*>(instances.memory.mapped());
+    uint32_t instance_count = 0U;
+
+    // one bounding sphere per object and submesh, laid out model by model and submesh by submesh,
+    // all culled in a single pass
+    model_matrices_.clear();
+    for(const components::gameobject* obj: draw_order_)
+        model_matrices_.push_back(transforms_.world_matrix(obj->transform));
+    spheres_.clear();
+    for(std::size_t group_begin = 0U; group_begin < draw_order_.size();) {
+        const std::size_t group_end = end_of_group(group_begin);
+        for(const components::submesh& mesh: draw_order_[group_begin]->model->submeshes()) {
+            for(std::size_t obj = group_begin; obj < group_end; ++obj) {
+                const glm::mat4 submesh_matrix = model_matrices_[obj] * mesh.transform;
+                // submeshes without bounds are never culled
+                if(mesh.bounds.empty())
+                    spheres_.push_back(glm::vec3 {submesh_matrix[3]},
+                                       std::numeric_limits<float>::infinity());
+                else
+                    spheres_.push_back(
+                        glm::vec3 {submesh_matrix * glm::vec4 {mesh.bounds.center(), 1.0f}},
+                        glm::length(mesh.bounds.extent()) * 0.5f * max_scale(submesh_matrix));
+            }
+        }
+        group_begin = group_end;
+    }
+    spheres_.cull(view_frustum, visible_);
+
+    // the draws are queued with their sort keys, models are ranked in the order they are visited
+    sort_keys_.clear();
+    sort_values_.clear();
+    queued_draws_.clear();
+    uint32_t model_rank = 0U;
+    auto visible = visible_.cbegin();
+    std::size_t group_sphere = 0U;
+    std::size_t group_end = 0U;
+    for(std::size_t group_begin = 0U; group_begin < draw_order_.size(); group_begin = group_end) {
+        group_end = end_of_group(group_begin);
+        components::model& group_model = *draw_order_[group_begin]->model;
+        const components::gameobject* const* group = draw_order_.data() + group_begin;
+        const glm::mat4* group_matrices = model_matrices_.data() + group_begin;
+        const std::size_t member_count = group_end - group_begin;
+
+        // evicted models are culled on the host side data, visible ones are restored
+        const bool resident = group_model.resident();
+
+        const std::vector<components::submesh>& submeshes = group_model.submeshes();
+        const std::size_t next_group_sphere = group_sphere + submeshes.size() * member_count;
+        for(std::size_t submesh_i = 0U; submesh_i < submeshes.size(); ++submesh_i) {
+            const components::submesh& mesh = submeshes[submesh_i];
+            const std::size_t first_sphere = group_sphere + submesh_i * member_count;
+
+            // sort the visible instances of the submesh by their level of detail, each level's
+            // draw is as deep as its nearest instance
+            for(std::vector<std::size_t>& bucket: lod_buckets_)
+                bucket.clear();
+            lod_depths_.fill(std::numeric_limits<float>::infinity());
+            const auto first_visible = visible;
+            for(; (visible != visible_.cend()) && (*visible < first_sphere + member_count);
+                ++visible) {
+                const std::size_t member = *visible - first_sphere;
+                const glm::mat4 model_view = view * group_matrices[member] * mesh.transform;
+                const std::size_t level = select_lod(mesh, model_view, pixels_per_unit);
+                lod_buckets_[level].push_back(member);
+                const float depth =
+                    mesh.bounds.empty()
+                        ? 0.0f
+                        : -(model_view * glm::vec4 {mesh.bounds.center(), 1.0f}).z;
+                lod_depths_[level] = std::min(lod_depths_[level], depth);
+            }
+            if(visible == first_visible)
+                continue;
+            if(!resident) {
+                group_model.request_residency();
+                break;
+            }
+            group_model.mark_drawn();
+
+            const glm::mat4 mesh_transform = mesh.transform * group_model.vertex_transform();
+            for(std::size_t level = 0U; level < lod_buckets_.size(); ++level) {
+                const std::vector<std::size_t>& bucket = lod_buckets_[level];
+                if(bucket.empty())
+                    continue;
+                const uint32_t first_instance = instance_count;
+                for(const std::size_t member: bucket)
+                    instance_data[instance_count++] = components::instance {
+                        .model_matrix = group_matrices[member] * mesh_transform,
+                        .colour = glm::vec4 {group[member]->colour, 1.0f}};
+
+                // instanced draws are drawn whole, only single instances are culled per meshlet
+                const sort_criteria criteria {.material = mesh.material_id,
+                                              .depth = lod_depths_[level],
+                                              .model_rank = model_rank};
+                if((level > 0U) || (mesh.meshlet_count == 0U) || (bucket.size() > 1U)) {
+                    add_draw(group_model,
+                             group_model.draw_command(submesh_i,
+                                                      level,
+                                                      static_cast<uint32_t>(bucket.size()),
+                                                      first_instance),
+                             criteria);
+                    continue;
+                }
+
+                const glm::mat4 submesh_matrix = group_matrices[bucket.front()] * mesh.transform;
+                const float scale = max_scale(submesh_matrix);
+                const components::meshlet* clusters =
+                    group_model.meshlets().data() + mesh.first_meshlet;
+                std::size_t run_start = 0U;
+                for(std::size_t meshlet_i = 0U; meshlet_i <= mesh.meshlet_count; ++meshlet_i) {
+                    if((meshlet_i < mesh.meshlet_count)
+                       && meshlet_visible(clusters[meshlet_i],
+                                          submesh_matrix,
+                                          scale,
+                                          view_frustum,
+                                          camera_position,
+                                          cone_culling_))
+                        continue;
+                    if(meshlet_i > run_start)
+                        add_draw(group_model,
+                                 group_model.meshlet_draw_command(
+                                     submesh_i, run_start, meshlet_i - run_start, first_instance),
+                                 criteria);
+                    run_start = meshlet_i + 1U;
+                }
+            }
+        }
+        // the spheres of submeshes skipped for an evicted model are left over
+        visible = std::lower_bound(visible, visible_.cend(), next_group_sphere);
+        group_sphere = next_group_sphere;
+        ++model_rank;
+    }
+    sort_draws();
+
+    if(submission_ == submission::parallel) {
+        record_secondaries(
+            command_buffer, frame_index, extent, inheritance, *instances.buffer);
+        return;
+    }
+
+    vk::Buffer indirect_buffer {};
+    if((submission_ == submission::indirect) && !draws_.empty()) {
+        const vk::DeviceSize stride = sizeof(vk::DrawIndexedIndirectCommand);
+        frame_buffer& commands = reserve_frame_buffer(indirect_buffers_.at(frame_index),
+                                                      draws_.size() * stride,
+                                                      vk::BufferUsageFlagBits::eIndirectBuffer,
+                                                      MIN_DRAW_CAPACITY * stride);
+        std::memcpy(commands.memory.mapped(), draws_.data(), draws_.size() * stride);
+        indirect_buffer = *commands.buffer;
+    }
+    bind_frame_state(command_buffer, *instances.buffer, frame_index);
+    record_draws(command_buffer, 0U, draws_.size(), indirect_buffer);
+}
+
+void render_system::cull_gameobjects(vk::raii::CommandBuffer& command_buffer,
+                                     std::vector<components::gameobject>& gameobjects,
+                                     camera& cam,
+                                     const uint32_t frame_index) {
+    if(submission_ != submission::gpu_culled)
+        return;
+
+    frame_buffer& instances = reserve_instances(frame_index, sort_by_model(gameobjects));
+    auto* const instance_data = reinterpret_cast<components::instance*>(instances.memory.mapped());
+    uint32_t instance_count = 0U;
+
+    // one candidate per object and submesh, batched by pipeline and index buffer binding
+    candidates_.clear();
+    batches_.clear();
+    std::size_t group_end = 0U;
+    for(std::size_t group_begin = 0U; group_begin < draw_order_.size(); group_begin = group_end) {
+        group_end = end_of_group(group_begin);
+        components::model& group_model = *draw_order_[group_begin]->model;
+        // visibility is only known to the device, so every model in use is kept resident
+        if(!group_model.resident()) {
+            group_model.request_residency();
+            continue;
+        }
+        group_model.mark_drawn();
+
+        const std::optional<vk::IndexType> index_type =
+            group_model.has_indices() ? std::optional {group_model.index_type()} : std::nullopt;
+        auto batch = std::find_if(batches_.begin(), batches_.end(), [&](const draw_batch& b) {
+            return (b.format == group_model.format()) && (b.index_type == index_type);
+        });
+        if(batch == batches_.end())
+            batch = batches_.insert(batch,
+                                    draw_batch {.format = group_model.format(),
+                                                .index_type = index_type,
+                                                .first_draw = 0U,
+                                                .draw_count = 0U});
+        const auto batch_index = static_cast<uint32_t>(batch - batches_.begin());
+
+        // the vertex transform scales and translates each axis, flat axes have no inverse
+        const glm::mat4& vertex_transform = group_model.vertex_transform();
+        glm::vec3 inverse_scale {0.0f};
+        for(glm::length_t axis = 0; axis < 3; ++axis) {
+            if(vertex_transform[axis][axis] != 0.0f)
+                inverse_scale[axis] = 1.0f / vertex_transform[axis][axis];
+        }
+
+        const std::vector<components::submesh>& submeshes = group_model.submeshes();
+        for(std::size_t submesh_i = 0U; submesh_i < submeshes.size(); ++submesh_i) {
+            const components::submesh& mesh = submeshes[submesh_i];
+            const vk::DrawIndexedIndirectCommand command =
+                group_model.draw_command(submesh_i, 0U, 1U, 0U);
+            // the sphere is placed by the instance's matrix, which includes the vertex transform,
+            // submeshes without bounds are never culled
+            glm::vec4 sphere {0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity()};
+            if(!mesh.bounds.empty())
+                sphere = glm::vec4 {
+                    (mesh.bounds.center() - glm::vec3 {vertex_transform[3]}) * inverse_scale,
+                    glm::length(mesh.bounds.extent()) * 0.5f};
+
+            const glm::mat4 mesh_transform = mesh.transform * vertex_transform;
+            for(std::size_t obj = group_begin; obj < group_end; ++obj) {
+                candidates_.push_back(
+                    gpu_culler::candidate {.sphere = sphere,
+                                           .inverse_scale = glm::vec4 {inverse_scale, 1.0f},
+                                           .index_count = command.indexCount,
+                                           .first_index = command.firstIndex,
+                                           .vertex_offset = command.vertexOffset,
+                                           .first_instance = instance_count,
+                                           .batch = batch_index,
+                                           .first_command = 0U,
+                                           .indexed = index_type ? 1U : 0U,
+                                           .padding = 0U});
+                instance_data[instance_count++] =
+                    components::instance {.model_matrix =
+                                              transforms_.world_matrix(draw_order_[obj]->transform)
+                                              * mesh_transform,
+                                          .colour = glm::vec4 {draw_order_[obj]->colour, 1.0f}};
+            }
+            batch->draw_count += static_cast<uint32_t>(group_end - group_begin);
+        }
+    }
+
+    // every batch reserves room for all of its candidates being visible
+    uint32_t first_command = 0U;
+    for(draw_batch& batch: batches_) {
+        batch.first_draw = first_command;
+        first_command += batch.draw_count;
+    }
+    for(gpu_culler::candidate& candidate: candidates_)
+        candidate.first_command = batches_[candidate.batch].first_draw;
+
+    culled_projection_view_ = cam.projection_matrix() * cam.view_matrix();
+    gpu_culler_->record(command_buffer,
+                        frame_index,
+                        candidates_,
+                        static_cast<uint32_t>(batches_.size()),
+                        *instances.buffer,
+                        frustum::from_matrix(culled_projection_view_),
+                        occlusion_culling());
+}
+
+void render_system::cull_occluded(vk::raii::CommandBuffer& command_buffer,
+                                  const uint32_t frame_index,
+                                  const depth_attachment& depth) {
+    if(!occlusion_culling())
+        return;
+    depth_pyramid_->build(command_buffer, frame_index, depth);
+    gpu_culler_->record_occlusion(
+        command_buffer, frame_index, *depth_pyramid_, culled_projection_view_, depth.extent);
+}
+
+void render_system::render_disoccluded(vk::raii::CommandBuffer& command_buffer,
+                                       const uint32_t frame_index) {
+    if(!occlusion_culling())
+        return;
+    bind_frame_state(command_buffer, *instance_buffers_[frame_index]->buffer, frame_index);
+    record_culled_draws(command_buffer, frame_index, true);
+}
+
+auto render_system::sort_by_model(std::vector<components::gameobject>& gameobjects)
+    -> std::size_t {
+    sort_keys_.clear();
+    sort_values_.clear();
+    std::size_t max_instances = 0U;
+    for(std::size_t obj = 0U; obj < gameobjects.size(); ++obj) {
+        // objects whose model is still streaming in without a placeholder are not drawn
+        if(!gameobjects[obj].model)
+            continue;
+        sort_keys_.push_back(reinterpret_cast<std::uintptr_t>(gameobjects[obj].model.get()));
+        sort_values_.push_back(static_cast<uint32_t>(obj));
+        max_instances += gameobjects[obj].model->submeshes().size();
+    }
+    sorter_.sort(sort_keys_, sort_values_);
+    draw_order_.clear();
+    for(const uint32_t obj: sort_values_)
+        draw_order_.push_back(&gameobjects[obj]);
+    return max_instances;
+}
+
+auto render_system::end_of_group(const std::size_t group_begin) const -> std::size_t {
+    std::size_t group_end = group_begin + 1U;
+    while((group_end < draw_order_.size())
+          && (draw_order_[group_end]->model == draw_order_[group_begin]->model))
+        ++group_end;
+    return group_end;
+}
+
+auto render_system::reserve_instances(const uint32_t frame_index, const std::size_t count)
+    -> frame_buffer& {
+    // the culling compute pass reads the model matrices as a storage buffer
+    return reserve_frame_buffer(instance_buffers_.at(frame_index),
+                                count * sizeof(components::instance),
+                                vk::BufferUsageFlagBits::eVertexBuffer
+                                    | vk::BufferUsageFlagBits::eStorageBuffer,
+                                MIN_INSTANCE_CAPACITY * sizeof(components::instance));
+}
+
+auto render_system::add_draw(const components::model& model,
+                             const vk::DrawIndexedIndirectCommand& command,
+                             const sort_criteria& criteria) -> void {
+    const std::optional<vk::IndexType> index_type =
+        model.has_indices() ? std::optional {model.index_type()} : std::nullopt;
+    sort_keys_.push_back(draw_key(
+        model.format(), index_type, criteria.material, criteria.depth, criteria.model_rank));
+    sort_values_.push_back(static_cast<uint32_t>(queued_draws_.size()));
+    queued_draws_.push_back(
+        queued_draw {.command = command, .format = model.format(), .index_type = index_type});
+}
+
+auto render_system::sort_draws() -> void {
+    sorter_.sort(sort_keys_, sort_values_);
+
+    // draws sharing a pipeline and index type are adjacent now, they form the batches
+    draws_.clear();
+    batches_.clear();
+    for(const uint32_t queued: sort_values_) {
+        const queued_draw& draw = queued_draws_[queued];
+        if(batches_.empty() || (batches_.back().format != draw.format)
+           || (batches_.back().index_type != draw.index_type))
+            batches_.push_back(draw_batch {.format = draw.format,
+                                           .index_type = draw.index_type,
+                                           .first_draw = static_cast<uint32_t>(draws_.size()),
+                                           .draw_count = 0U});
+        draws_.push_back(draw.command);
+        ++batches_.back().draw_count;
+    }
+}
+
+auto render_system::bind_frame_state(vk::raii::CommandBuffer& command_buffer,
+                                     const vk::Buffer instances,
+                                     const uint32_t frame_index) -> void {
+    // all models live in the geometry arena, its vertex buffer is bound once for the frame
+    command_buffer.bindVertexBuffers(
+        0U, {*driver_.geometry().vertex_buffer(), instances}, {0U, 0U});
+    // both pipelines share the layout, the camera's set stays bound across their bindings
+    command_buffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, *pipeline_layout_, 0U, *camera_sets_[frame_index], {});
+}
+
+auto render_system::record_draws(vk::raii::CommandBuffer& command_buffer,
+                                 const std::size_t first_draw,
+                                 const std::size_t last_draw,
+                                 const vk::Buffer indirect_buffer) -> void {
+    const vk::DeviceSize stride = sizeof(vk::DrawIndexedIndirectCommand);
+    const geometry_arena& arena = driver_.geometry();
+    std::optional<components::vertex_format> bound_format {};
+    std::optional<vk::IndexType> bound_index_type {};
+    for(const draw_batch& batch: batches_) {
+        // the part of the batch within the range
+        const std::size_t begin = std::max<std::size_t>(batch.first_draw, first_draw);
+        const std::size_t end =
+            std::min<std::size_t>(batch.first_draw + batch.draw_count, last_draw);
+        if(begin >= end)
+            continue;
+
+        if(bound_format != batch.format) {
+            bound_format = batch.format;
+            pipeline& format_pipeline =
+                (*bound_format == components::vertex_format::compact) ? *compact_pipeline_
+                                                                       : *pipeline_;
+            command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                        format_pipeline.vk_pipeline());
+        }
+
+        const std::span<const vk::DrawIndexedIndirectCommand> batch_draws {draws_.data() + begin,
+                                                                           end - begin};
+        // models without indices are rare, their draws are always recorded one by one
+        if(!batch.index_type) {
+            for(const vk::DrawIndexedIndirectCommand& draw: batch_draws)
+                command_buffer.draw(draw.indexCount,
+                                    draw.instanceCount,
+                                    static_cast<uint32_t>(draw.vertexOffset),
+                                    draw.firstInstance);
+            continue;
+        }
+
+        if(bound_index_type != batch.index_type) {
+            bound_index_type = batch.index_type;
+            command_buffer.bindIndexBuffer(*arena.index_buffer(), 0U, *bound_index_type);
+        }
+        if(!indirect_buffer) {
+            for(const vk::DrawIndexedIndirectCommand& draw: batch_draws)
+                command_buffer.drawIndexed(draw.indexCount,
+                                           draw.instanceCount,
+                                           draw.firstIndex,
+                                           draw.vertexOffset,
+                                           draw.firstInstance);
+            continue;
+        }
+        for(std::size_t first = begin; first < end; first += max_draw_indirect_count_)
+            command_buffer.drawIndexedIndirect(
+                indirect_buffer,
+                first * stride,
+                static_cast<uint32_t>(std::min<std::size_t>(end - first, max_draw_indirect_count_)),
+                static_cast<uint32_t>(stride));
+    }
+}
+
+auto render_system::record_secondaries(vk::raii::CommandBuffer& command_buffer,
+                                       const uint32_t frame_index,
+                                       const vk::Extent2D extent,
+                                       const vk::CommandBufferInheritanceInfo& inheritance,
+                                       const vk::Buffer instances) -> void {
+    // one range per thread at most, but no range so small that recording it costs less than
+    // executing another secondary command buffer
+    const std::size_t range_count =
+        std::min(recording_workers_->size() + 1U,
+                 (draws_.size() + MIN_DRAWS_PER_SECONDARY - 1U) / MIN_DRAWS_PER_SECONDARY);
+    secondaries_.assign(range_count, vk::CommandBuffer {});
+
+    const vk::Viewport viewport {.x = 0.0f,
+                                 .y = 0.0f,
+                                 .width = static_cast<float>(extent.width),
+                                 .height = static_cast<float>(extent.height),
+                                 .minDepth = 0.0f,
+                                 .maxDepth = 1.0f};
+    const vk::Rect2D scissor {{0, 0}, extent};
+    recording_workers_->parallel_for(range_count, [&](const std::size_t range) {
+        // each thread records from its own pool of the frame
+        vk::raii::CommandBuffer& secondary =
+            command_buffers_.acquire(frame_index, vk::CommandBufferLevel::eSecondary);
+        secondary.begin(vk::CommandBufferBeginInfo {
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+                     | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+            .pInheritanceInfo = &inheritance});
+        // dynamic state is not inherited from the primary command buffer
+        secondary.setViewport(0U, viewport);
+        secondary.setScissor(0U, scissor);
+        bind_frame_state(secondary, instances, frame_index);
+        record_draws(secondary,
+                     draws_.size() * range / range_count,
+                     draws_.size() * (range + 1U) / range_count,
+                     {});
+        secondary.end();
+        secondaries_[range] = *secondary;
+    });
+
+    if(!secondaries_.empty())
+        command_buffer.executeCommands(secondaries_);
+}
+
+auto render_system::record_culled_draws(vk::raii::CommandBuffer& command_buffer,
+                                        const uint32_t frame_index,
+                                        const bool disoccluded) -> void {
+    const vk::DeviceSize stride = sizeof(vk::DrawIndexedIndirectCommand);
+    const vk::Buffer commands = gpu_culler_->commands(frame_index);
+    const vk::Buffer counts = gpu_culler_->counts(frame_index);
+    // the occlusion pass' commands and counts follow those of the first pass
+    const vk::DeviceSize first_command = disoccluded ? gpu_culler_->candidate_count(frame_index)
+                                                     : 0U;
+    const std::size_t first_count = disoccluded ? batches_.size() : 0U;
+    for(std::size_t batch_i = 0U; batch_i < batches_.size(); ++batch_i) {
+        const draw_batch& batch = batches_[batch_i];
+        pipeline& format_pipeline = (batch.format == components::vertex_format::compact)
+                                        ? *compact_pipeline_
+                                        : *pipeline_;
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                    format_pipeline.vk_pipeline());
+
+        // the device reads how many of the batch's commands survived culling
+        const vk::DeviceSize first = (first_command + batch.first_draw) * stride;
+        const vk::DeviceSize count_offset = (first_count + batch_i) * sizeof(uint32_t);
+        const uint32_t max_count = std::min(batch.draw_count, max_draw_indirect_count_);
+        if(!batch.index_type) {
+            command_buffer.drawIndirectCount(
+                commands, first, counts, count_offset, max_count, static_cast<uint32_t>(stride));
+            continue;
+        }
+        command_buffer.bindIndexBuffer(
+            *driver_.geometry().index_buffer(), 0U, *batch.index_type);
+        command_buffer.drawIndexedIndirectCount(
+            commands, first, counts, count_offset, max_count, static_cast<uint32_t>(stride));
+    }
+}
+
+auto render_system::reserve_frame_buffer(std::optional<frame_buffer>& buffer,
+                                         const vk::DeviceSize size,
+                                         const vk::BufferUsageFlags usage,
+                                         const vk::DeviceSize min_size) -> frame_buffer& {
+    if(!buffer || (buffer->size < size)) {
+        // the frame's fence was waited on, the buffer it used last time is no longer read
+        const vk::DeviceSize new_size =
+            std::max({size, min_size, buffer ? buffer->size * 2U : vk::DeviceSize {0U}});
+        vk::raii::Buffer created = driver_.create_buffer(new_size, usage);
+        memory_allocation memory = driver_.bind_memory_to_buffer(
+            created,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        buffer.reset();
+        buffer.emplace(frame_buffer {
+            .buffer = std::move(created), .memory = std::move(memory), .size = new_size});
     }
+    return *buffer;
 }
 }
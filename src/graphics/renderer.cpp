@@ -1,4 +1,5 @@
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 
 #include <vulkan/vulkan.hpp>
@@ -20,7 +21,9 @@ renderer::renderer(gpu& gpu, gpu_driver& driver, window& window, const bool try_
     driver_(driver),
     window_(window),
     swapchain_(std::make_unique<swapchain>(gpu, driver, window.get_extent(), try_mailbox)),
-    command_buffers_(create_command_buffers(swapchain::MAX_FRAMES_IN_FLIGHT)) { }
+    command_buffers_(driver.device(),
+                     driver.queue_families().graphics_family.value(),
+                     swapchain::MAX_FRAMES_IN_FLIGHT) { }
 
 vk::raii::CommandBuffer* renderer::begin_frame() {
     if(is_frame_started_)
@@ -40,12 +43,27 @@ vk::raii::CommandBuffer* renderer::begin_frame() {
     if((result != vk::Result::eSuccess) && (result != vk::Result::eSuboptimalKHR))
         throw std::runtime_error("Failed to acquire swapchain image");
 
-    vk::raii::CommandBuffer& command_buffer = current_command_buffer();
-    command_buffer.begin({});
-    return &command_buffer;
+    // the frame's fence was waited on, all command buffers recorded for it last time are done
+    command_buffers_.reset(current_frame_index_);
+    current_command_buffer_ = &command_buffers_.acquire(current_frame_index_);
+    current_command_buffer_->begin(
+        vk::CommandBufferBeginInfo {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    return current_command_buffer_;
+}
+
+void renderer::begin_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer,
+                                          const vk::SubpassContents contents) {
+    begin_renderpass(command_buffer, *swapchain_->render_pass(), contents);
+}
+
+void renderer::resume_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer) {
+    begin_renderpass(
+        command_buffer, *swapchain_->resume_render_pass(), vk::SubpassContents::eInline);
 }
 
-void renderer::begin_swapchain_renderpass(vk::raii::CommandBuffer& command_buffer) {
+void renderer::begin_renderpass(vk::raii::CommandBuffer& command_buffer,
+                                const vk::RenderPass render_pass,
+                                const vk::SubpassContents contents) {
     if(!is_frame_started_)
         throw std::runtime_error("Cannot end frame while frame is not in progress");
     if(&command_buffer != &current_command_buffer())
@@ -60,7 +78,7 @@ void renderer::begin_swapchain_renderpass(vk::raii::CommandBuffer& command_buffe
     clear_values[1].depthStencil = clear_depthstencil;
 
     vk::RenderPassBeginInfo render_pass_begin_info {
-        .renderPass = *swapchain_->render_pass(),
+        .renderPass = render_pass,
         .framebuffer = swapchain_->get_framebuffer(current_image_index_),
         .renderArea = {.offset = {0, 0}, .extent = swapchain_->get_extent()},
         .clearValueCount = static_cast<uint32_t>(clear_values.size()),
@@ -75,16 +93,21 @@ void renderer::begin_swapchain_renderpass(vk::raii::CommandBuffer& command_buffe
 
     vk::Rect2D scissor {{0, 0}, swapchain_->get_extent()};
 
-    command_buffer.beginRenderPass(render_pass_begin_info, vk::SubpassContents::eInline);
-    command_buffer.setViewport(0U, viewport);
-    command_buffer.setScissor(0U, scissor);
+    command_buffer.beginRenderPass(render_pass_begin_info, contents);
+    // only secondary command buffers may be recorded into the render pass otherwise
+    if(contents == vk::SubpassContents::eInline) {
+        command_buffer.setViewport(0U, viewport);
+        command_buffer.setScissor(0U, scissor);
+    }
 }
 
-vk::raii::CommandBuffers renderer::create_command_buffers(const std::size_t count) {
-    vk::CommandBufferAllocateInfo alloc_info {.commandPool = driver_.command_pool(),
-                                              .level = vk::CommandBufferLevel::ePrimary,
-                                              .commandBufferCount = static_cast<uint32_t>(count)};
-    return vk::raii::CommandBuffers(driver_.device(), alloc_info);
+vk::CommandBufferInheritanceInfo renderer::swapchain_inheritance() {
+    if(!is_frame_started_)
+        throw std::runtime_error("Cannot inherit from a frame that is not in progress");
+    return vk::CommandBufferInheritanceInfo {
+        .renderPass = *swapchain_->render_pass(),
+        .subpass = 0U,
+        .framebuffer = swapchain_->get_framebuffer(current_image_index_)};
 }
 
 void renderer::end_frame() {
@@ -125,7 +148,10 @@ void renderer::recreate_swapchain() {
         glfwWaitEvents();
     }
 
-    driver_.device().waitIdle();
+    {
+        const std::lock_guard lock {driver_.queue_mutex()};
+        driver_.device().waitIdle();
+    }
     if(swapchain_)
         swapchain_ = std::make_unique<swapchain>(
             gpu_, driver_, window_.get_extent(), std::move(swapchain_), try_mailbox_);
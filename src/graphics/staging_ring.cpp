@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "arcticvox/graphics/memory_allocator.hpp"
+#include "arcticvox/graphics/staging_ring.hpp"
+
+namespace arcticvox::graphics {
+
+staging_ring::staging_ring(vk::raii::Device& device,
+                           memory_allocator& allocator,
+                           const vk::DeviceSize size) :
+    device_(device),
+    size_(size),
+    buffer_(device_,
+            vk::BufferCreateInfo {.size = size,
+                                  .usage = vk::BufferUsageFlagBits::eTransferSrc,
+                                  .sharingMode = vk::SharingMode::eExclusive}),
+    timeline_(device_,
+              vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> {
+                  {}, {.semaphoreType = vk::SemaphoreType::eTimeline}}
+                  .get<vk::SemaphoreCreateInfo>()) {
+    memory_ = allocator.allocate(
+        buffer_.getMemoryRequirements(),
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        memory_allocator::resource_kind::linear);
+    buffer_.bindMemory(memory_.memory(), memory_.offset());
+}
+
+staging_ring::~staging_ring() {
+    while(wait_oldest()) { }
+}
+
+auto staging_ring::allocate(const vk::DeviceSize size, const vk::DeviceSize alignment)
+    -> std::optional<region> {
+    if(size > size_)
+        throw std::invalid_argument("Staging allocation is larger than the ring");
+
+    // an empty ring starts over at the front, so a request of the full size always fits
+    if(head_ == tail_) {
+        head_ = (head_ + size_ - 1U) / size_ * size_;
+        tail_ = head_;
+    }
+
+    const uint64_t offset = head_ % size_;
+    uint64_t begin = (offset + alignment - 1U) / alignment * alignment;
+    // allocations never wrap, the rest of the buffer is skipped instead
+    if(begin + size > size_)
+        begin = size_;
+    const uint64_t end = head_ + (begin - offset) + size;
+    if(end - tail_ > size_)
+        return std::nullopt;
+
+    head_ = end;
+    const uint64_t start = (end - size) % size_;
+    return region {.offset = start, .data = memory_.mapped() + start};
+}
+
+auto staging_ring::submit() -> uint64_t {
+    in_flight_.push_back(batch {.ticket = next_ticket_, .end = head_});
+    return next_ticket_++;
+}
+
+auto staging_ring::retire() -> void {
+    const uint64_t completed = timeline_.getCounterValue();
+    while(!in_flight_.empty() && (in_flight_.front().ticket <= completed))
+        release_front();
+}
+
+auto staging_ring::wait(const uint64_t ticket) -> void {
+    if(in_flight_.empty() || (in_flight_.front().ticket > ticket))
+        return;
+
+    const uint64_t value = std::min(ticket, in_flight_.back().ticket);
+    const vk::SemaphoreWaitInfo wait_info {
+        .semaphoreCount = 1U, .pSemaphores = &(*timeline_), .pValues = &value};
+    if(device_.waitSemaphores(wait_info, std::numeric_limits<uint64_t>::max())
+       != vk::Result::eSuccess)
+        throw std::runtime_error("Failed waiting for staged uploads");
+    while(!in_flight_.empty() && (in_flight_.front().ticket <= value))
+        release_front();
+}
+
+auto staging_ring::wait_oldest() -> bool {
+    if(in_flight_.empty())
+        return false;
+    wait(in_flight_.front().ticket);
+    return true;
+}
+
+auto staging_ring::release_front() -> void {
+    tail_ = in_flight_.front().end;
+    released_ticket_ = in_flight_.front().ticket;
+    in_flight_.pop_front();
+}
+
+}
@@ -1,5 +1,6 @@
 #include <cstdint>
 #include <limits>
+#include <mutex>
 #include <stdexcept>
 #include <vector>
 
@@ -12,6 +13,7 @@
 #include <spdlog/spdlog.h>
 
 #include "arcticvox/graphics/gpu.hpp"
+#include "arcticvox/graphics/memory_allocator.hpp"
 #include "arcticvox/graphics/swapchain.hpp"
 
 namespace arcticvox::graphics {
@@ -24,8 +26,12 @@ swapchain::swapchain(gpu& gpu, gpu_driver& driver, vk::Extent2D extent, const bo
     swapchain_(create_swapchain()),
     swapchain_images_(swapchain_.getImages()),
     swapchain_image_views_(create_swapchain_image_views(swapchain_images_.size())),
-    render_pass_(create_renderpass()),
+    render_pass_(create_renderpass(false)),
+    resume_render_pass_(create_renderpass(true)),
     depth_image_format_(find_depth_format()),
+    depth_aspect_((depth_image_format_ == vk::Format::eD32Sfloat)
+                      ? vk::ImageAspectFlags {vk::ImageAspectFlagBits::eDepth}
+                      : vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil),
     depth_images_(create_depth_images(swapchain_images_.size())),
     depth_image_memories_(create_device_memories(swapchain_images_.size())),
     depth_image_views_(create_depth_image_views(swapchain_images_.size())),
@@ -47,8 +53,12 @@ swapchain::swapchain(gpu& gpu,
     swapchain_(create_swapchain()),
     swapchain_images_(swapchain_.getImages()),
     swapchain_image_views_(create_swapchain_image_views(swapchain_images_.size())),
-    render_pass_(create_renderpass()),
+    render_pass_(create_renderpass(false)),
+    resume_render_pass_(create_renderpass(true)),
     depth_image_format_(find_depth_format()),
+    depth_aspect_((depth_image_format_ == vk::Format::eD32Sfloat)
+                      ? vk::ImageAspectFlags {vk::ImageAspectFlagBits::eDepth}
+                      : vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil),
     depth_images_(create_depth_images(swapchain_images_.size())),
     depth_image_memories_(create_device_memories(swapchain_images_.size())),
     depth_image_views_(create_depth_image_views(swapchain_images_.size())),
@@ -88,7 +98,9 @@ auto swapchain::create_depth_images(std::size_t count) const -> std::vector<vk::
                                         .arrayLayers = 1U,
                                         .samples = vk::SampleCountFlagBits::e1,
                                         .tiling = vk::ImageTiling::eOptimal,
-                                        .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                                        // sampled to build the occlusion culling depth pyramid
+                                        .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment
+                                                 | vk::ImageUsageFlagBits::eSampled,
                                         .sharingMode = vk::SharingMode::eExclusive,
                                         .initialLayout = vk::ImageLayout::eUndefined};
         depth_images.push_back(vk::raii::Image(driver_.get().device(), image_info));
@@ -151,40 +163,12 @@ auto swapchain::choose_surface_format(const std::vector<vk::SurfaceFormatKHR>& f
 }
 
 auto swapchain::create_device_memories(const std::size_t count) const
-    -> std::vector<vk::raii::DeviceMemory> {
-    std::vector<vk::raii::DeviceMemory> buffers;
-
-    vk::PhysicalDeviceMemoryProperties memory_properties =
-        gpu_.get().physical_device().getMemoryProperties();
-
-    for(std::size_t i = 0U; i < count; ++i) {
-        vk::MemoryRequirements memory_requirements = depth_images_.at(i).getMemoryRequirements();
-
-        uint32_t type_bits = memory_requirements.memoryTypeBits;
-        uint32_t type_index {~0U};
-
-        for(uint32_t type_count = 0U; i < memory_properties.memoryTypeCount; ++type_count) {
-            if((type_bits & 1U)
-               && ((memory_properties.memoryTypes[type_count].propertyFlags
-                    & vk::MemoryPropertyFlagBits::eDeviceLocal)
-                   == vk::MemoryPropertyFlagBits::eDeviceLocal)) {
-                type_index = type_count;
-                break;
-            }
-            type_bits >>= 1;
-        }
-
-        if(type_index == uint32_t {~0U})
-            throw std::runtime_error("Failed to setup depth buffer");
-
-        vk::MemoryAllocateInfo memory_allocate_info {.allocationSize = memory_requirements.size,
-                                                     .memoryTypeIndex = type_index};
-        buffers.push_back(vk::raii::DeviceMemory(driver_.get().device(), memory_allocate_info));
-
-        // bind memory to image
-        depth_images_.at(i).bindMemory(buffers.back(), 0U);
-    }
-    return buffers;
+    -> std::vector<memory_allocation> {
+    std::vector<memory_allocation> memories;
+    for(std::size_t i = 0U; i < count; ++i)
+        memories.push_back(driver_.get().bind_memory_to_image(
+            depth_images_.at(i), vk::MemoryPropertyFlagBits::eDeviceLocal));
+    return memories;
 }
 
 auto swapchain::create_fences(const std::size_t count) const -> std::vector<vk::raii::Fence> {
@@ -216,16 +200,21 @@ auto swapchain::create_framebuffers(const std::size_t count) const
     return framebuffers;
 }
 
-auto swapchain::create_renderpass() -> vk::raii::RenderPass {
+auto swapchain::create_renderpass(const bool resume) -> vk::raii::RenderPass {
+    const vk::AttachmentLoadOp load_op =
+        resume ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
+
+    // the depth is kept, occlusion culling samples it after the render pass
     vk::AttachmentDescription depth_attachment {
         .flags = {},
         .format = find_depth_format(),
         .samples = vk::SampleCountFlagBits::e1,
-        .loadOp = vk::AttachmentLoadOp::eClear,
-        .storeOp = vk::AttachmentStoreOp::eDontCare,
+        .loadOp = load_op,
+        .storeOp = vk::AttachmentStoreOp::eStore,
         .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
         .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
-        .initialLayout = vk::ImageLayout::eUndefined,
+        .initialLayout = resume ? vk::ImageLayout::eDepthStencilReadOnlyOptimal
+                                : vk::ImageLayout::eUndefined,
         .finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal};
 
     vk::AttachmentReference depth_attachment_ref {
@@ -234,11 +223,13 @@ auto swapchain::create_renderpass() -> vk::raii::RenderPass {
     vk::AttachmentDescription colour_attachment {.flags = {},
                                                  .format = swapchain_image_format_,
                                                  .samples = vk::SampleCountFlagBits::e1,
-                                                 .loadOp = vk::AttachmentLoadOp::eClear,
+                                                 .loadOp = load_op,
                                                  .storeOp = vk::AttachmentStoreOp::eStore,
                                                  .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
                                                  .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
-                                                 .initialLayout = vk::ImageLayout::eUndefined,
+                                                 .initialLayout =
+                                                     resume ? vk::ImageLayout::ePresentSrcKHR
+                                                            : vk::ImageLayout::eUndefined,
                                                  .finalLayout = vk::ImageLayout::ePresentSrcKHR};
 
     vk::AttachmentReference colour_attachment_ref {
@@ -258,6 +249,14 @@ auto swapchain::create_renderpass() -> vk::raii::RenderPass {
         .srcAccessMask = static_cast<vk::AccessFlagBits>(0U),
         .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite
                          | vk::AccessFlagBits::eDepthStencilAttachmentWrite};
+    if(resume) {
+        // the previous render pass' colour writes and the depth pyramid's reads come first
+        dependency.srcStageMask |= vk::PipelineStageFlagBits::eComputeShader;
+        dependency.dstStageMask |= vk::PipelineStageFlagBits::eLateFragmentTests;
+        dependency.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+        dependency.dstAccessMask |= vk::AccessFlagBits::eColorAttachmentRead
+                                    | vk::AccessFlagBits::eDepthStencilAttachmentRead;
+    }
 
     std::array<vk::AttachmentDescription, 2U> attachments {colour_attachment, depth_attachment};
 
@@ -360,7 +359,8 @@ auto swapchain::find_depth_format() const -> vk::Format {
     return gpu_.get().find_supported_format(
         {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint},
         vk::ImageTiling::eOptimal,
-        vk::FormatFeatureFlagBits::eDepthStencilAttachment);
+        vk::FormatFeatureFlagBits::eDepthStencilAttachment
+            | vk::FormatFeatureFlagBits::eSampledImage);
 }
 
 auto swapchain::submit_command_buffers(vk::raii::CommandBuffer& command_buffer,
@@ -377,6 +377,7 @@ auto swapchain::submit_command_buffers(vk::raii::CommandBuffer& command_buffer,
         .pSignalSemaphores = &(*render_finished_semaphores_.at(current_frame_)),
     };
 
+    const std::lock_guard lock {driver_.get().queue_mutex()};
     driver_.get().graphics_queue().submit(submit_info, *in_flight_fences_.at(current_frame_));
 
     vk::PresentInfoKHR present_info {
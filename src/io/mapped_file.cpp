@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <filesystem>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "arcticvox/io/mapped_file.hpp"
+
+namespace arcticvox::io {
+
+mapped_file::mapped_file(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return;
+
+    struct stat file_stat {};
+    if((fstat(fd, &file_stat) != 0) || (file_stat.st_size <= 0)) {
+        close(fd);
+        return;
+    }
+
+    const std::size_t file_sz = static_cast<std::size_t>(file_stat.st_size);
+    void* mapping = mmap(nullptr, file_sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file, the descriptor is not needed anymore
+    close(fd);
+
+    if(mapping == MAP_FAILED) {
+        spdlog::warn("Failed to map file {}", path.string());
+        return;
+    }
+
+    // the whole file is read front to back in all current use cases
+    madvise(mapping, file_sz, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const std::byte*>(mapping);
+    size_ = file_sz;
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept :
+    data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0U)) { }
+
+mapped_file::~mapped_file() {
+    unmap();
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+    if(this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0U);
+    }
+    return *this;
+}
+
+void mapped_file::unmap() {
+    if(data_)
+        munmap(const_cast<std::byte*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0U;
+}
+
+}
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include "arcticvox/common/hash.hpp"
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/submesh.hpp"
+#include "arcticvox/components/vertex.hpp"
+#include "arcticvox/io/filesystem.hpp"
+#include "arcticvox/io/mapped_file.hpp"
+#include "arcticvox/io/mesh_cache.hpp"
+#include "arcticvox/io/model_builder.hpp"
+
+namespace arcticvox::io {
+
+namespace {
+constexpr uint64_t CACHE_ALIGNMENT = 16U;
+
+uint64_t align_up(const uint64_t value, const uint64_t alignment) {
+    return (value + alignment - 1U) & ~(alignment - 1U);
+}
+
+/**
+ * @brief Returns whether the range lies within an array of the size
+ */
+bool range_valid(const uint64_t first, const uint64_t count, const uint64_t size) {
+    return (first <= size) && (count <= size - first);
+}
+
+/**
+ * @brief Returns whether an index range lies within the indices and all vertices it references,
+ * relative to the vertex offset, lie within the vertices
+ */
+bool indexed_range_valid(const std::vector<uint32_t>& indices,
+                         const uint32_t first_index,
+                         const uint32_t index_count,
+                         const int32_t vertex_offset,
+                         const std::size_t vertex_count) {
+    if(!range_valid(first_index, index_count, indices.size()) || (vertex_offset < 0))
+        return false;
+    if(index_count == 0U)
+        return true;
+    const auto first = indices.cbegin() + first_index;
+    const uint32_t max_index = *std::max_element(first, first + index_count);
+    return static_cast<uint64_t>(vertex_offset) + max_index < vertex_count;
+}
+
+/**
+ * @brief Returns whether all ranges of the submeshes and meshlets lie within their arrays
+ */
+bool ranges_valid(const std::vector<components::vertex>& vertices,
+                  const std::vector<uint32_t>& indices,
+                  const std::vector<components::submesh>& submeshes,
+                  const std::vector<components::meshlet>& meshlets) {
+    for(const components::meshlet& cluster: meshlets) {
+        if(!range_valid(cluster.first_index, cluster.index_count, indices.size()))
+            return false;
+    }
+    for(const components::submesh& mesh: submeshes) {
+        if((mesh.lod_count > components::submesh::MAX_LODS)
+           || !range_valid(mesh.first_meshlet, mesh.meshlet_count, meshlets.size()))
+            return false;
+        for(std::size_t level = 0U; level < mesh.level_count(); ++level) {
+            const components::submesh_lod lod = mesh.lod(level);
+            if(!indexed_range_valid(
+                   indices, lod.first_index, lod.index_count, mesh.vertex_offset, vertices.size()))
+                return false;
+        }
+    }
+    return true;
+}
+}
+
+std::filesystem::path mesh_cache::cache_path(const uint64_t source_hash, const uint32_t flags) {
+    return get_current_exe_path() / "cache"
+           / fmt::format("{:016x}_{:02x}.avxmesh", source_hash, flags);
+}
+
+std::optional<uint64_t> mesh_cache::hash_file(const std::filesystem::path& path) {
+    const mapped_file file {path};
+    if(!file.is_open())
+        return std::nullopt;
+    return hash_bytes(file.data(), file.size());
+}
+
+bool mesh_cache::load(const std::filesystem::path& cache_file,
+                      const uint64_t source_hash,
+                      const uint64_t source_size,
+                      const uint32_t flags,
+                      model_builder& builder) {
+    const mapped_file file {cache_file};
+    if(!file.is_open() || (file.size() < sizeof(mesh_cache_header)))
+        return false;
+
+    mesh_cache_header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if((header.magic != MAGIC) || (header.version != VERSION)) {
+        spdlog::info("Ignoring mesh cache {} with outdated format", cache_file.string());
+        return false;
+    }
+    if((header.source_hash != source_hash) || (header.source_size != source_size)
+       || (header.flags != flags)
+       || (header.vertex_stride != sizeof(components::vertex)))
+        return false;
+
+    // compare counts before multiplying, a corrupted header must not be able to overflow the sizes
+    const uint64_t file_sz = file.size();
+    if((header.vertex_count > file_sz / sizeof(components::vertex))
+       || (header.index_count > file_sz / sizeof(uint32_t))
+       || (header.submesh_count > file_sz / sizeof(components::submesh))
+       || (header.vertex_offset > file_sz) || (header.index_offset > file_sz)
+       || (header.meshlet_count > file_sz / sizeof(components::meshlet))
+       || (header.submesh_offset > file_sz) || (header.meshlet_offset > file_sz)
+       || (header.vertex_offset + header.vertex_count * sizeof(components::vertex) > file_sz)
+       || (header.index_offset + header.index_count * sizeof(uint32_t) > file_sz)
+       || (header.submesh_offset + header.submesh_count * sizeof(components::submesh) > file_sz)
+       || (header.meshlet_offset + header.meshlet_count * sizeof(components::meshlet) > file_sz)) {
+        spdlog::warn("Mesh cache {} is truncated", cache_file.string());
+        return false;
+    }
+
+    const uint64_t vertex_bytes = header.vertex_count * sizeof(components::vertex);
+    const uint64_t index_bytes = header.index_count * sizeof(uint32_t);
+    const uint64_t submesh_bytes = header.submesh_count * sizeof(components::submesh);
+    const uint64_t meshlet_bytes = header.meshlet_count * sizeof(components::meshlet);
+
+    std::vector<components::vertex> vertices(header.vertex_count);
+    std::memcpy(vertices.data(), file.data() + header.vertex_offset, vertex_bytes);
+    std::vector<uint32_t> indices(header.index_count);
+    std::memcpy(indices.data(), file.data() + header.index_offset, index_bytes);
+    std::vector<components::submesh> submeshes(header.submesh_count);
+    std::memcpy(submeshes.data(), file.data() + header.submesh_offset, submesh_bytes);
+    std::vector<components::meshlet> meshlets(header.meshlet_count);
+    std::memcpy(meshlets.data(), file.data() + header.meshlet_offset, meshlet_bytes);
+
+    // a stale or corrupted cache must not make the draws read past the buffers
+    if(!ranges_valid(vertices, indices, submeshes, meshlets)) {
+        spdlog::warn("Mesh cache {} holds ranges outside of its data", cache_file.string());
+        return false;
+    }
+
+    builder.vertices = std::move(vertices);
+    builder.indices = std::move(indices);
+    builder.submeshes = std::move(submeshes);
+    builder.meshlets = std::move(meshlets);
+    builder.bounds.min =
+        glm::vec3 {header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]};
+    builder.bounds.max =
+        glm::vec3 {header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]};
+    return true;
+}
+
+bool mesh_cache::store(const std::filesystem::path& cache_file,
+                       const uint64_t source_hash,
+                       const uint64_t source_size,
+                       const uint32_t flags,
+                       const model_builder& builder) {
+    std::error_code error;
+    std::filesystem::create_directories(cache_file.parent_path(), error);
+    if(error) {
+        spdlog::warn("Unable to create mesh cache directory {}: {}",
+                     cache_file.parent_path().string(),
+                     error.message());
+        return false;
+    }
+
+    const uint64_t vertex_bytes = builder.vertices.size() * sizeof(components::vertex);
+    const uint64_t index_bytes = builder.indices.size() * sizeof(uint32_t);
+    const uint64_t submesh_bytes = builder.submeshes.size() * sizeof(components::submesh);
+    const uint64_t meshlet_bytes = builder.meshlets.size() * sizeof(components::meshlet);
+
+    mesh_cache_header header {
+        .magic = MAGIC,
+        .version = VERSION,
+        .source_hash = source_hash,
+        .source_size = source_size,
+        .vertex_stride = sizeof(components::vertex),
+        .flags = flags,
+        .vertex_count = builder.vertices.size(),
+        .vertex_offset = align_up(sizeof(mesh_cache_header), CACHE_ALIGNMENT),
+        .index_count = builder.indices.size(),
+        .index_offset = 0U,
+        .submesh_count = builder.submeshes.size(),
+        .submesh_offset = 0U,
+        .meshlet_count = builder.meshlets.size(),
+        .meshlet_offset = 0U,
+        .bounds_min = {builder.bounds.min.x, builder.bounds.min.y, builder.bounds.min.z},
+        .bounds_max = {builder.bounds.max.x, builder.bounds.max.y, builder.bounds.max.z}};
+    header.index_offset = align_up(header.vertex_offset + vertex_bytes, CACHE_ALIGNMENT);
+    header.submesh_offset = align_up(header.index_offset + index_bytes, CACHE_ALIGNMENT);
+    header.meshlet_offset = align_up(header.submesh_offset + submesh_bytes, CACHE_ALIGNMENT);
+
+    // every writer has a file of its own, threads and processes storing the same cache at once
+    // must not write into each other's file before it is renamed
+    std::filesystem::path tmp_file = cache_file;
+    tmp_file += fmt::format(".{:016x}_{:08x}.tmp",
+                            std::hash<std::thread::id> {}(std::this_thread::get_id()),
+                            std::random_device {}());
+    {
+        std::ofstream ofs {tmp_file, std::ios::binary | std::ios::trunc};
+        if(!ofs.good()) {
+            spdlog::warn("Unable to write mesh cache {}", tmp_file.string());
+            return false;
+        }
+
+        const auto write_padding = [&ofs](const uint64_t until) {
+            static constexpr char zeroes[CACHE_ALIGNMENT] {};
+            const auto pos = static_cast<uint64_t>(ofs.tellp());
+            ofs.write(zeroes, static_cast<std::streamsize>(until - pos));
+        };
+
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_padding(header.vertex_offset);
+        ofs.write(reinterpret_cast<const char*>(builder.vertices.data()),
+                  static_cast<std::streamsize>(vertex_bytes));
+        write_padding(header.index_offset);
+        ofs.write(reinterpret_cast<const char*>(builder.indices.data()),
+                  static_cast<std::streamsize>(index_bytes));
+        write_padding(header.submesh_offset);
+        ofs.write(reinterpret_cast<const char*>(builder.submeshes.data()),
+                  static_cast<std::streamsize>(submesh_bytes));
+        write_padding(header.meshlet_offset);
+        ofs.write(reinterpret_cast<const char*>(builder.meshlets.data()),
+                  static_cast<std::streamsize>(meshlet_bytes));
+
+        if(!ofs.good()) {
+            spdlog::warn("Failed writing mesh cache {}", tmp_file.string());
+            ofs.close();
+            std::filesystem::remove(tmp_file, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmp_file, cache_file, error);
+    if(error) {
+        spdlog::warn("Unable to move mesh cache into place: {}", error.message());
+        std::filesystem::remove(tmp_file, error);
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include "arcticvox/components/bounds.hpp"
+#include "arcticvox/components/vertex.hpp"
+#include "arcticvox/io/mesh_optimiser.hpp"
+
+namespace arcticvox::io {
+
+namespace {
+constexpr uint32_t NO_VERTEX = ~0U;
+constexpr int OVERDRAW_GRID_SIZE = 256;
+
+/**
+ * @brief FIFO cache simulation based on timestamps
+ *
+ * @details A vertex is in the cache if fewer than cache_size misses happened since it was last
+ * inserted. Advancing the time by more than the cache size empties the cache.
+ */
+class fifo_cache {
+  public:
+    fifo_cache(const std::size_t vertex_count, const uint32_t cache_size) :
+        cache_size_(cache_size), time_(cache_size + 1U), timestamps_(vertex_count, 0U) { }
+
+    /**
+     * @brief Accesses a vertex and returns true on a cache miss
+     */
+    bool access(const uint32_t vertex) {
+        if(time_ - timestamps_[vertex] <= cache_size_)
+            return false;
+        timestamps_[vertex] = time_++;
+        return true;
+    }
+
+    void clear() {
+        time_ += cache_size_ + 1U;
+    }
+
+  private:
+    uint32_t cache_size_;
+    uint32_t time_;
+    std::vector<uint32_t> timestamps_;
+};
+
+float edge_function(const glm::vec3& a, const glm::vec3& b, const float px, const float py) {
+    return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+}
+
+bool is_top_left(const glm::vec3& a, const glm::vec3& b) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    return (dy < 0.0f) || ((dy == 0.0f) && (dx < 0.0f));
+}
+
+bool covers(const float weight, const bool top_left) {
+    return (weight > 0.0f) || ((weight == 0.0f) && top_left);
+}
+
+/**
+ * @brief Rasterises a counter clockwise triangle (x, y in pixels, z as depth) with depth test
+ *
+ * @return The number of fragments that passed the depth test
+ */
+std::size_t rasterise_triangle(const glm::vec3& v0,
+                               const glm::vec3& v1,
+                               const glm::vec3& v2,
+                               std::vector<float>& depth_buffer) {
+    const float area = edge_function(v0, v1, v2.x, v2.y);
+    if(area <= 0.0f)
+        return 0U;
+
+    constexpr int max_pixel = OVERDRAW_GRID_SIZE - 1;
+    const int min_x = std::max(static_cast<int>(std::min({v0.x, v1.x, v2.x})), 0);
+    const int min_y = std::max(static_cast<int>(std::min({v0.y, v1.y, v2.y})), 0);
+    const int max_x = std::min(static_cast<int>(std::max({v0.x, v1.x, v2.x})), max_pixel);
+    const int max_y = std::min(static_cast<int>(std::max({v0.y, v1.y, v2.y})), max_pixel);
+
+    const bool top_left_0 = is_top_left(v1, v2);
+    const bool top_left_1 = is_top_left(v2, v0);
+    const bool top_left_2 = is_top_left(v0, v1);
+
+    std::size_t shaded = 0U;
+    for(int y = min_y; y <= max_y; ++y) {
+        for(int x = min_x; x <= max_x; ++x) {
+            const float px = static_cast<float>(x) + 0.5f;
+            const float py = static_cast<float>(y) + 0.5f;
+            const float w0 = edge_function(v1, v2, px, py);
+            const float w1 = edge_function(v2, v0, px, py);
+            const float w2 = edge_function(v0, v1, px, py);
+            if(!covers(w0, top_left_0) || !covers(w1, top_left_1) || !covers(w2, top_left_2))
+                continue;
+
+            const float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+            float& stored = depth_buffer[static_cast<std::size_t>(y) * OVERDRAW_GRID_SIZE + x];
+            if(depth < stored) {
+                stored = depth;
+                ++shaded;
+            }
+        }
+    }
+    return shaded;
+}
+}
+
+mesh_optimisation_report mesh_optimiser::optimise(std::span<components::vertex> vertices,
+                                                  std::span<uint32_t> indices) {
+    mesh_optimisation_report report {};
+    report.cache_before = analyse_vertex_cache(indices, vertices.size());
+    report.overdraw_before = analyse_overdraw(indices, vertices);
+
+    optimise_vertex_cache(indices, vertices.size());
+    optimise_overdraw(indices, vertices);
+    optimise_vertex_fetch(vertices, indices);
+
+    report.cache_after = analyse_vertex_cache(indices, vertices.size());
+    report.overdraw_after = analyse_overdraw(indices, vertices);
+    return report;
+}
+
+void mesh_optimiser::optimise_vertex_cache(std::span<uint32_t> indices,
+                                           const std::size_t vertex_count,
+                                           const uint32_t cache_size) {
+    const std::size_t triangle_count = indices.size() / 3U;
+    if(triangle_count < 2U)
+        return;
+
+    // number of not yet emitted triangles per vertex
+    std::vector<uint32_t> live_count(vertex_count, 0U);
+    for(const uint32_t index: indices)
+        ++live_count[index];
+
+    // triangles adjacent to every vertex, vertex v owns [adjacency_offsets[v], [v + 1])
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1U, 0U);
+    std::inclusive_scan(
+        live_count.cbegin(), live_count.cend(), adjacency_offsets.begin() + 1U, std::plus<> {});
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacency_offsets.cbegin(), adjacency_offsets.cend() - 1U);
+        for(std::size_t tri = 0U; tri < triangle_count; ++tri) {
+            for(std::size_t corner = 0U; corner < 3U; ++corner)
+                adjacency[fill[indices[tri * 3U + corner]]++] = static_cast<uint32_t>(tri);
+        }
+    }
+
+    std::vector<uint32_t> cache_timestamps(vertex_count, 0U);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32_t> dead_end_stack;
+    dead_end_stack.reserve(indices.size());
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint32_t time = cache_size + 1U;
+    std::size_t cursor = 0U;
+
+    const auto skip_dead_end = [&]() -> uint32_t {
+        while(!dead_end_stack.empty()) {
+            const uint32_t vertex = dead_end_stack.back();
+            dead_end_stack.pop_back();
+            if(live_count[vertex] > 0U)
+                return vertex;
+        }
+        for(; cursor < vertex_count; ++cursor) {
+            if(live_count[cursor] > 0U)
+                return static_cast<uint32_t>(cursor);
+        }
+        return NO_VERTEX;
+    };
+
+    for(uint32_t fanning = skip_dead_end(); fanning != NO_VERTEX;) {
+        candidates.clear();
+        // emit all remaining triangles around the fanning vertex
+        for(uint32_t adj = adjacency_offsets[fanning]; adj < adjacency_offsets[fanning + 1U];
+            ++adj) {
+            const uint32_t tri = adjacency[adj];
+            if(emitted[tri])
+                continue;
+            for(std::size_t corner = 0U; corner < 3U; ++corner) {
+                const uint32_t vertex = indices[tri * 3U + corner];
+                output.push_back(vertex);
+                dead_end_stack.push_back(vertex);
+                candidates.push_back(vertex);
+                --live_count[vertex];
+                if(time - cache_timestamps[vertex] > cache_size)
+                    cache_timestamps[vertex] = time++;
+            }
+            emitted[tri] = true;
+        }
+
+        // continue with the oldest candidate that stays in the cache while its fan is emitted
+        uint32_t next = NO_VERTEX;
+        int64_t best_priority = -1;
+        for(const uint32_t vertex: candidates) {
+            if(live_count[vertex] == 0U)
+                continue;
+            int64_t priority = 0;
+            if(time - cache_timestamps[vertex] + 2U * live_count[vertex] <= cache_size)
+                priority = time - cache_timestamps[vertex];
+            if(priority > best_priority) {
+                best_priority = priority;
+                next = vertex;
+            }
+        }
+        fanning = (next != NO_VERTEX) ? next : skip_dead_end();
+    }
+
+    std::copy(output.cbegin(), output.cend(), indices.begin());
+}
+
+void mesh_optimiser::optimise_overdraw(std::span<uint32_t> indices,
+                                       std::span<const components::vertex> vertices,
+                                       const float threshold,
+                                       const uint32_t cache_size) {
+    const std::size_t triangle_count = indices.size() / 3U;
+    if(triangle_count < 2U)
+        return;
+
+    // cache misses of every triangle in the current order
+    std::vector<uint8_t> triangle_misses(triangle_count);
+    std::size_t total_misses = 0U;
+    {
+        fifo_cache cache {vertices.size(), cache_size};
+        for(std::size_t tri = 0U; tri < triangle_count; ++tri) {
+            for(std::size_t corner = 0U; corner < 3U; ++corner)
+                triangle_misses[tri] += cache.access(indices[tri * 3U + corner]) ? 1U : 0U;
+            total_misses += triangle_misses[tri];
+        }
+    }
+    const float acmr_limit =
+        threshold * static_cast<float>(total_misses) / static_cast<float>(triangle_count);
+
+    // hard boundaries at triangles missing the cache with all three vertices, starting a new
+    // cluster there can't make the cache behaviour worse
+    std::vector<std::size_t> hard_boundaries;
+    for(std::size_t tri = 0U; tri < triangle_count; ++tri) {
+        if((tri == 0U) || (triangle_misses[tri] == 3U))
+            hard_boundaries.push_back(tri);
+    }
+    hard_boundaries.push_back(triangle_count);
+
+    // soft boundaries inside the hard clusters, wherever the cluster so far stays within the ACMR
+    // limit even when drawn with a cold cache
+    std::vector<std::size_t> cluster_starts;
+    {
+        fifo_cache cache {vertices.size(), cache_size};
+        for(std::size_t hard = 0U; hard + 1U < hard_boundaries.size(); ++hard) {
+            const std::size_t end = hard_boundaries[hard + 1U];
+            std::size_t start = hard_boundaries[hard];
+            std::size_t cluster_misses = 0U;
+            cluster_starts.push_back(start);
+            cache.clear();
+
+            for(std::size_t tri = start; tri < end; ++tri) {
+                for(std::size_t corner = 0U; corner < 3U; ++corner)
+                    cluster_misses += cache.access(indices[tri * 3U + corner]) ? 1U : 0U;
+
+                if((tri + 1U < end)
+                   && (static_cast<float>(cluster_misses)
+                       <= acmr_limit * static_cast<float>(tri + 1U - start))) {
+                    start = tri + 1U;
+                    cluster_misses = 0U;
+                    cluster_starts.push_back(start);
+                    cache.clear();
+                }
+            }
+        }
+    }
+    cluster_starts.push_back(triangle_count);
+    const std::size_t cluster_count = cluster_starts.size() - 1U;
+
+    // area weighted centroid and normal of every cluster and of the whole mesh
+    std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3 {0.0f});
+    std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3 {0.0f});
+    glm::vec3 mesh_centroid {0.0f};
+    float mesh_area = 0.0f;
+
+    for(std::size_t cluster = 0U; cluster < cluster_count; ++cluster) {
+        float cluster_area = 0.0f;
+        for(std::size_t tri = cluster_starts[cluster]; tri < cluster_starts[cluster + 1U]; ++tri) {
+            const glm::vec3& p0 = vertices[indices[tri * 3U]].position.pos;
+            const glm::vec3& p1 = vertices[indices[tri * 3U + 1U]].position.pos;
+            const glm::vec3& p2 = vertices[indices[tri * 3U + 2U]].position.pos;
+
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(normal);
+            const glm::vec3 centroid = (p0 + p1 + p2) * (area / 3.0f);
+
+            cluster_centroids[cluster] += centroid;
+            cluster_normals[cluster] += normal;
+            cluster_area += area;
+            mesh_centroid += centroid;
+            mesh_area += area;
+        }
+        if(cluster_area > 0.0f)
+            cluster_centroids[cluster] /= cluster_area;
+    }
+    if(mesh_area > 0.0f)
+        mesh_centroid /= mesh_area;
+
+    // clusters on the outside of the mesh facing away from its centre are likely to occlude the
+    // others, so they are drawn first
+    std::vector<float> sort_keys(cluster_count, 0.0f);
+    for(std::size_t cluster = 0U; cluster < cluster_count; ++cluster) {
+        const float normal_length = glm::length(cluster_normals[cluster]);
+        if(normal_length > 0.0f)
+            sort_keys[cluster] =
+                glm::dot(cluster_centroids[cluster] - mesh_centroid, cluster_normals[cluster])
+                / normal_length;
+    }
+
+    std::vector<std::size_t> cluster_order(cluster_count);
+    std::iota(cluster_order.begin(), cluster_order.end(), 0U);
+    std::stable_sort(
+        cluster_order.begin(), cluster_order.end(), [&](const std::size_t a, const std::size_t b) {
+            return sort_keys[a] > sort_keys[b];
+        });
+
+    const std::vector<uint32_t> source(indices.begin(), indices.end());
+    auto output = indices.begin();
+    for(const std::size_t cluster: cluster_order) {
+        output = std::copy(source.cbegin() + cluster_starts[cluster] * 3U,
+                           source.cbegin() + cluster_starts[cluster + 1U] * 3U,
+                           output);
+    }
+}
+
+std::size_t mesh_optimiser::optimise_vertex_fetch(std::span<components::vertex> vertices,
+                                                  std::span<uint32_t> indices) {
+    std::vector<uint32_t> remap(vertices.size(), NO_VERTEX);
+    uint32_t next_vertex = 0U;
+    for(uint32_t& index: indices) {
+        if(remap[index] == NO_VERTEX)
+            remap[index] = next_vertex++;
+        index = remap[index];
+    }
+
+    const std::vector<components::vertex> source(vertices.begin(), vertices.end());
+    for(std::size_t vertex = 0U; vertex < source.size(); ++vertex) {
+        if(remap[vertex] != NO_VERTEX)
+            vertices[remap[vertex]] = source[vertex];
+    }
+    return next_vertex;
+}
+
+vertex_cache_statistics mesh_optimiser::analyse_vertex_cache(std::span<const uint32_t> indices,
+                                                             const std::size_t vertex_count,
+                                                             const uint32_t cache_size) {
+    vertex_cache_statistics statistics {.triangle_count = indices.size() / 3U};
+
+    fifo_cache cache {vertex_count, cache_size};
+    std::vector<bool> referenced(vertex_count, false);
+    for(const uint32_t index: indices) {
+        statistics.vertices_transformed += cache.access(index) ? 1U : 0U;
+        if(!referenced[index]) {
+            referenced[index] = true;
+            ++statistics.vertex_count;
+        }
+    }
+    return statistics;
+}
+
+overdraw_statistics mesh_optimiser::analyse_overdraw(std::span<const uint32_t> indices,
+                                                     std::span<const components::vertex> vertices) {
+    overdraw_statistics statistics {};
+    if(indices.size() < 3U)
+        return statistics;
+
+    components::aabb bounds {};
+    for(const uint32_t index: indices)
+        bounds.extend(vertices[index].position.pos);
+    const glm::vec3 extent = bounds.extent();
+    const float max_extent = std::max({extent.x, extent.y, extent.z});
+    if(max_extent <= 0.0f)
+        return statistics;
+    const float scale = static_cast<float>(OVERDRAW_GRID_SIZE) / max_extent;
+
+    std::vector<float> depth_buffer(OVERDRAW_GRID_SIZE * OVERDRAW_GRID_SIZE);
+    for(int axis = 0; axis < 3; ++axis) {
+        const int axis_u = (axis + 1) % 3;
+        const int axis_v = (axis + 2) % 3;
+
+        // counter clockwise triangles in the (u, v) plane face the positive axis, so that view
+        // looks down the negative axis. The mirrored view swaps the image axes, which flips the
+        // winding, and looks down the positive axis. Every triangle is front facing in one view.
+        for(const bool mirrored: {false, true}) {
+            std::fill(depth_buffer.begin(), depth_buffer.end(), std::numeric_limits<float>::max());
+
+            const auto project = [&](const uint32_t index) {
+                const glm::vec3 p = (vertices[index].position.pos - bounds.min) * scale;
+                return mirrored ? glm::vec3 {p[axis_v], p[axis_u], p[axis]}
+                                : glm::vec3 {p[axis_u], p[axis_v], -p[axis]};
+            };
+
+            for(std::size_t i = 0U; i + 2U < indices.size(); i += 3U) {
+                statistics.pixels_shaded += rasterise_triangle(project(indices[i]),
+                                                               project(indices[i + 1U]),
+                                                               project(indices[i + 2U]),
+                                                               depth_buffer);
+            }
+            statistics.pixels_covered += static_cast<std::size_t>(
+                std::count_if(depth_buffer.cbegin(), depth_buffer.cend(), [](const float depth) {
+                    return depth != std::numeric_limits<float>::max();
+                }));
+        }
+    }
+    return statistics;
+}
+
+}
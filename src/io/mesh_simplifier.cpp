@@ -0,0 +1,403 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include "arcticvox/common/hash.hpp"
+#include "arcticvox/components/vertex.hpp"
+#include "arcticvox/io/mesh_simplifier.hpp"
+
+namespace arcticvox::io {
+
+namespace {
+constexpr uint32_t NO_VERTEX = ~0U;
+//! Weight of the constraint planes along open borders, relative to the face quadrics
+constexpr float BORDER_WEIGHT = 10.0f;
+//! Collapses turning a triangle's normal by more than ~75 degrees count as flips
+constexpr float MIN_NORMAL_COSINE = 0.25f;
+//! Collapses of a pass may cost this much more than the cheapest collapses needed for the target
+constexpr float PASS_COST_FACTOR = 1.5f;
+
+enum class vertex_kind : uint8_t {
+    manifold,    //!< Interior vertex, may collapse onto any neighbour
+    border,      //!< On exactly one open border, may only collapse along it
+    locked       //!< On a seam or several borders, never moves
+};
+
+/**
+ * @brief Symmetric 4x4 error matrix of a set of planes, plus the summed plane weights
+ */
+struct quadric {
+    float a00 = 0.0f, a01 = 0.0f, a02 = 0.0f, a03 = 0.0f;
+    float a11 = 0.0f, a12 = 0.0f, a13 = 0.0f;
+    float a22 = 0.0f, a23 = 0.0f;
+    float a33 = 0.0f;
+    float weight = 0.0f;
+
+    /**
+     * @brief Creates the quadric of the plane dot(normal, p) + distance = 0
+     */
+    static quadric from_plane(const glm::vec3& normal, const float distance, const float weight) {
+        const glm::vec3 n = normal * weight;
+        return quadric {.a00 = n.x * normal.x,
+                        .a01 = n.x * normal.y,
+                        .a02 = n.x * normal.z,
+                        .a03 = n.x * distance,
+                        .a11 = n.y * normal.y,
+                        .a12 = n.y * normal.z,
+                        .a13 = n.y * distance,
+                        .a22 = n.z * normal.z,
+                        .a23 = n.z * distance,
+                        .a33 = weight * distance * distance,
+                        .weight = weight};
+    }
+
+    quadric& operator+=(const quadric& other) {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a03 += other.a03;
+        a11 += other.a11;
+        a12 += other.a12;
+        a13 += other.a13;
+        a22 += other.a22;
+        a23 += other.a23;
+        a33 += other.a33;
+        weight += other.weight;
+        return *this;
+    }
+
+    /**
+     * @brief Returns the weighted sum of squared distances of the point to the planes
+     */
+    [[nodiscard]] float evaluate(const glm::vec3& p) const {
+        const float value = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+                            + 2.0f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+                            + 2.0f * (a03 * p.x + a13 * p.y + a23 * p.z) + a33;
+        return std::max(value, 0.0f);
+    }
+};
+
+/**
+ * @brief A possible collapse of vertex from onto vertex to
+ */
+struct collapse {
+    uint32_t from;
+    uint32_t to;
+    float cost;    //!< Squared distance error of the collapse
+};
+
+uint64_t edge_key(const uint32_t from, const uint32_t to) {
+    return (static_cast<uint64_t>(from) << 32U) | to;
+}
+
+/**
+ * @brief Maps every vertex to the first vertex with a bitwise identical position
+ */
+std::vector<uint32_t> build_position_remap(std::span<const components::vertex> vertices) {
+    std::vector<uint32_t> slots(std::bit_ceil(std::max<std::size_t>(vertices.size() * 2U, 16U)),
+                                NO_VERTEX);
+    const std::size_t mask = slots.size() - 1U;
+
+    std::vector<uint32_t> remap(vertices.size());
+    for(uint32_t vtx_i = 0U; vtx_i < vertices.size(); ++vtx_i) {
+        const glm::vec3& pos = vertices[vtx_i].position.pos;
+        for(std::size_t slot = hash_bytes(&pos, sizeof(pos)) & mask;; slot = (slot + 1U) & mask) {
+            if(slots[slot] == NO_VERTEX) {
+                slots[slot] = vtx_i;
+                remap[vtx_i] = vtx_i;
+                break;
+            }
+            if(vertices[slots[slot]].position.pos == pos) {
+                remap[vtx_i] = slots[slot];
+                break;
+            }
+        }
+    }
+    return remap;
+}
+
+/**
+ * @brief Returns the directed edges without an opposite edge, sorted, in position space
+ */
+std::vector<uint64_t> find_border_edges(std::span<const uint32_t> indices,
+                                        const std::vector<uint32_t>& position_remap) {
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for(std::size_t tri = 0U; tri < indices.size(); tri += 3U) {
+        for(std::size_t corner = 0U; corner < 3U; ++corner)
+            edges.push_back(edge_key(position_remap[indices[tri + corner]],
+                                     position_remap[indices[tri + (corner + 1U) % 3U]]));
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<uint64_t> border_edges;
+    for(const uint64_t edge: edges) {
+        const uint64_t opposite = (edge << 32U) | (edge >> 32U);
+        if(!std::binary_search(edges.cbegin(), edges.cend(), opposite))
+            border_edges.push_back(edge);
+    }
+    return border_edges;
+}
+
+glm::vec3 triangle_normal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+/**
+ * @brief Accumulates the area weighted face planes and the border constraint planes per vertex
+ */
+std::vector<quadric> build_quadrics(std::span<const uint32_t> indices,
+                                    std::span<const components::vertex> vertices,
+                                    const std::vector<uint32_t>& position_remap,
+                                    const std::vector<uint64_t>& border_edges) {
+    std::vector<quadric> quadrics(vertices.size());
+    for(std::size_t tri = 0U; tri < indices.size(); tri += 3U) {
+        const glm::vec3& p0 = vertices[indices[tri]].position.pos;
+        const glm::vec3& p1 = vertices[indices[tri + 1U]].position.pos;
+        const glm::vec3& p2 = vertices[indices[tri + 2U]].position.pos;
+        const glm::vec3 normal = triangle_normal(p0, p1, p2);
+        const float double_area = glm::length(normal);
+        if(double_area <= 0.0f)
+            continue;
+
+        const glm::vec3 unit_normal = normal / double_area;
+        const quadric face =
+            quadric::from_plane(unit_normal, -glm::dot(unit_normal, p0), double_area * 0.5f);
+        for(std::size_t corner = 0U; corner < 3U; ++corner)
+            quadrics[indices[tri + corner]] += face;
+
+        // planes through border edges, perpendicular to the face, keep borders in place
+        for(std::size_t corner = 0U; corner < 3U; ++corner) {
+            const uint32_t from = indices[tri + corner];
+            const uint32_t to = indices[tri + (corner + 1U) % 3U];
+            if(!std::binary_search(border_edges.cbegin(),
+                                   border_edges.cend(),
+                                   edge_key(position_remap[from], position_remap[to])))
+                continue;
+
+            const glm::vec3 edge = vertices[to].position.pos - vertices[from].position.pos;
+            const float edge_length = glm::length(edge);
+            if(edge_length <= 0.0f)
+                continue;
+            const glm::vec3 border_normal = glm::normalize(glm::cross(edge, unit_normal));
+            const quadric border = quadric::from_plane(
+                border_normal,
+                -glm::dot(border_normal, vertices[from].position.pos),
+                edge_length * edge_length * BORDER_WEIGHT);
+            quadrics[from] += border;
+            quadrics[to] += border;
+        }
+    }
+    return quadrics;
+}
+}
+
+simplification_result mesh_simplifier::simplify(std::span<uint32_t> destination,
+                                                std::span<const uint32_t> indices,
+                                                std::span<const components::vertex> vertices,
+                                                const std::size_t target_index_count,
+                                                const float target_error) {
+    std::vector<uint32_t> current(indices.begin(), indices.end());
+    const std::vector<uint32_t> position_remap = build_position_remap(vertices);
+
+    // vertices sharing their position with others sit on an attribute seam and stay locked
+    std::vector<uint32_t> position_use(vertices.size(), 0U);
+    for(const uint32_t canonical: position_remap)
+        ++position_use[canonical];
+
+    std::vector<quadric> quadrics = build_quadrics(
+        current, vertices, position_remap, find_border_edges(current, position_remap));
+
+    const float target_cost = (target_error < std::sqrt(std::numeric_limits<float>::max()))
+                                  ? target_error * target_error
+                                  : std::numeric_limits<float>::max();
+    float max_cost = 0.0f;
+
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<uint8_t> touched(vertices.size());
+    std::vector<vertex_kind> kinds(vertices.size());
+    std::vector<uint32_t> adjacency_offsets(vertices.size() + 1U);
+    std::vector<uint32_t> adjacency;
+    std::vector<collapse> collapses;
+    bool relaxed = false;
+
+    while(current.size() > target_index_count) {
+        const std::vector<uint64_t> border_edges = find_border_edges(current, position_remap);
+
+        std::vector<uint32_t> border_use(vertices.size(), 0U);
+        for(const uint64_t edge: border_edges) {
+            ++border_use[static_cast<uint32_t>(edge >> 32U)];
+            ++border_use[static_cast<uint32_t>(edge)];
+        }
+        for(uint32_t vtx_i = 0U; vtx_i < vertices.size(); ++vtx_i) {
+            const uint32_t canonical = position_remap[vtx_i];
+            if((position_use[canonical] > 1U) || (border_use[canonical] > 2U))
+                kinds[vtx_i] = vertex_kind::locked;
+            else if(border_use[canonical] == 2U)
+                kinds[vtx_i] = vertex_kind::border;
+            else
+                kinds[vtx_i] = vertex_kind::manifold;
+        }
+
+        // triangles around every vertex, as offsets into current
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0U);
+        for(const uint32_t index: current)
+            ++adjacency_offsets[index + 1U];
+        for(std::size_t vtx_i = 0U; vtx_i < vertices.size(); ++vtx_i)
+            adjacency_offsets[vtx_i + 1U] += adjacency_offsets[vtx_i];
+        adjacency.resize(current.size());
+        {
+            std::vector<uint32_t> fill(adjacency_offsets.cbegin(), adjacency_offsets.cend() - 1);
+            for(uint32_t index_i = 0U; index_i < current.size(); ++index_i)
+                adjacency[fill[current[index_i]]++] = index_i - index_i % 3U;
+        }
+
+        collapses.clear();
+        for(std::size_t tri = 0U; tri < current.size(); tri += 3U) {
+            for(std::size_t corner = 0U; corner < 3U; ++corner) {
+                const uint32_t from = current[tri + corner];
+                const uint32_t to = current[tri + (corner + 1U) % 3U];
+                for(const auto& [a, b]: {std::pair {from, to}, std::pair {to, from}}) {
+                    if(kinds[a] == vertex_kind::locked)
+                        continue;
+                    if((kinds[a] == vertex_kind::border)
+                       && !std::binary_search(border_edges.cbegin(),
+                                              border_edges.cend(),
+                                              edge_key(position_remap[a], position_remap[b]))
+                       && !std::binary_search(border_edges.cbegin(),
+                                              border_edges.cend(),
+                                              edge_key(position_remap[b], position_remap[a])))
+                        continue;
+
+                    quadric merged = quadrics[a];
+                    merged += quadrics[b];
+                    const float cost =
+                        (merged.weight > 0.0f)
+                            ? merged.evaluate(vertices[b].position.pos) / merged.weight
+                            : 0.0f;
+                    collapses.push_back(collapse {.from = a, .to = b, .cost = cost});
+                }
+            }
+        }
+        // interior edges were found from both of their triangles
+        std::sort(collapses.begin(), collapses.end(), [](const collapse& lhs, const collapse& rhs) {
+            return edge_key(lhs.from, lhs.to) < edge_key(rhs.from, rhs.to);
+        });
+        collapses.erase(std::unique(collapses.begin(),
+                                    collapses.end(),
+                                    [](const collapse& lhs, const collapse& rhs) {
+                                        return (lhs.from == rhs.from) && (lhs.to == rhs.to);
+                                    }),
+                        collapses.end());
+        if(collapses.empty())
+            break;
+        std::sort(collapses.begin(), collapses.end(), [](const collapse& lhs, const collapse& rhs) {
+            return lhs.cost < rhs.cost;
+        });
+
+        // every collapse removes about two triangles, the pass only takes collapses not much more
+        // expensive than the cheapest ones that would reach the target, more expensive ones are
+        // reconsidered once the cheap ones changed the mesh
+        const std::size_t collapse_goal =
+            std::min((current.size() - target_index_count) / 6U, collapses.size() - 1U);
+        const float pass_cost =
+            relaxed ? target_cost
+                    : std::min(target_cost, collapses[collapse_goal].cost * PASS_COST_FACTOR);
+
+        std::iota(remap.begin(), remap.end(), 0U);
+        std::fill(touched.begin(), touched.end(), 0U);
+        std::size_t triangle_count = current.size() / 3U;
+        std::size_t applied = 0U;
+        for(const collapse& candidate: collapses) {
+            if(triangle_count * 3U <= target_index_count || candidate.cost > pass_cost)
+                break;
+            if(touched[candidate.from] || touched[candidate.to])
+                continue;
+
+            // reject collapses that flip or fold any triangle which survives them
+            const glm::vec3& target_pos = vertices[candidate.to].position.pos;
+            const uint32_t target_position = position_remap[candidate.to];
+            std::size_t removed = 0U;
+            bool valid = true;
+            for(uint32_t adj_i = adjacency_offsets[candidate.from];
+                valid && adj_i < adjacency_offsets[candidate.from + 1U];
+                ++adj_i) {
+                const uint32_t tri = adjacency[adj_i];
+                glm::vec3 before[3];
+                glm::vec3 after[3];
+                bool collapsed = false;
+                for(std::size_t corner = 0U; corner < 3U; ++corner) {
+                    const uint32_t vtx = remap[current[tri + corner]];
+                    before[corner] = vertices[vtx].position.pos;
+                    after[corner] = (vtx == candidate.from) ? target_pos : before[corner];
+                    collapsed = collapsed || (position_remap[vtx] == target_position);
+                }
+                if(collapsed) {
+                    ++removed;
+                    continue;
+                }
+                const glm::vec3 normal_before = triangle_normal(before[0], before[1], before[2]);
+                const glm::vec3 normal_after = triangle_normal(after[0], after[1], after[2]);
+                valid = glm::dot(normal_before, normal_after)
+                        > MIN_NORMAL_COSINE * glm::length(normal_before)
+                              * glm::length(normal_after);
+            }
+            if(!valid)
+                continue;
+
+            remap[candidate.from] = candidate.to;
+            quadrics[candidate.to] += quadrics[candidate.from];
+            max_cost = std::max(max_cost, candidate.cost);
+            triangle_count -= removed;
+            ++applied;
+
+            // lock the whole one ring, the flip test above assumed all of it to stay in place
+            for(uint32_t adj_i = adjacency_offsets[candidate.from];
+                adj_i < adjacency_offsets[candidate.from + 1U];
+                ++adj_i) {
+                for(std::size_t corner = 0U; corner < 3U; ++corner)
+                    touched[current[adjacency[adj_i] + corner]] = 1U;
+            }
+            touched[candidate.to] = 1U;
+        }
+        if(applied == 0U) {
+            // all cheap collapses were rejected, give the expensive ones a chance before giving up
+            if(relaxed)
+                break;
+            relaxed = true;
+            continue;
+        }
+        relaxed = false;
+
+        // drop the triangles which lost an edge, they have a repeated position now
+        std::size_t write = 0U;
+        for(std::size_t tri = 0U; tri < current.size(); tri += 3U) {
+            const uint32_t v0 = remap[current[tri]];
+            const uint32_t v1 = remap[current[tri + 1U]];
+            const uint32_t v2 = remap[current[tri + 2U]];
+            if((position_remap[v0] == position_remap[v1])
+               || (position_remap[v1] == position_remap[v2])
+               || (position_remap[v0] == position_remap[v2]))
+                continue;
+            current[write++] = v0;
+            current[write++] = v1;
+            current[write++] = v2;
+        }
+        current.resize(write);
+    }
+
+    std::copy(current.cbegin(), current.cend(), destination.begin());
+    return simplification_result {.index_count = current.size(), .error = std::sqrt(max_cost)};
+}
+
+}
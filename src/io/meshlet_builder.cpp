@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include "arcticvox/components/bounds.hpp"
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/vertex.hpp"
+#include "arcticvox/io/meshlet_builder.hpp"
+
+namespace arcticvox::io {
+
+namespace {
+constexpr uint32_t NO_MESHLET = ~0U;
+constexpr uint32_t NO_TRIANGLE = ~0U;
+//! Normal cones wider than this (cosine of the half angle) are not worth testing
+constexpr float MIN_CONE_COSINE = 0.1f;
+}
+
+std::vector<components::meshlet> meshlet_builder::build(
+    std::span<uint32_t> indices,
+    std::span<const components::vertex> vertices,
+    const uint32_t max_vertices,
+    const uint32_t max_triangles) {
+    const std::size_t triangle_count = indices.size() / 3U;
+    std::vector<components::meshlet> meshlets;
+    if(triangle_count == 0U)
+        return meshlets;
+
+    // triangles around every vertex
+    std::vector<uint32_t> adjacency_offsets(vertices.size() + 1U, 0U);
+    for(const uint32_t index: indices)
+        ++adjacency_offsets[index + 1U];
+    for(std::size_t vtx_i = 0U; vtx_i < vertices.size(); ++vtx_i)
+        adjacency_offsets[vtx_i + 1U] += adjacency_offsets[vtx_i];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacency_offsets.cbegin(), adjacency_offsets.cend() - 1);
+        for(uint32_t index_i = 0U; index_i < indices.size(); ++index_i)
+            adjacency[fill[indices[index_i]]++] = index_i / 3U;
+    }
+
+    std::vector<glm::vec3> triangle_centers(triangle_count);
+    for(std::size_t tri = 0U; tri < triangle_count; ++tri)
+        triangle_centers[tri] = (vertices[indices[tri * 3U]].position.pos
+                                 + vertices[indices[tri * 3U + 1U]].position.pos
+                                 + vertices[indices[tri * 3U + 2U]].position.pos)
+                                / 3.0f;
+
+    std::vector<uint8_t> emitted(triangle_count, 0U);
+    std::vector<uint32_t> vertex_meshlet(vertices.size(), NO_MESHLET);
+    std::vector<uint32_t> meshlet_vertices;
+    std::vector<uint32_t> order;
+    order.reserve(triangle_count);
+
+    uint32_t meshlet_id = 0U;
+    std::size_t meshlet_triangles = 0U;
+    glm::vec3 center_sum {0.0f};
+    std::size_t seed = 0U;
+    const auto new_vertices = [&](const std::size_t tri) {
+        uint32_t count = 0U;
+        for(std::size_t corner = 0U; corner < 3U; ++corner)
+            count += (vertex_meshlet[indices[tri * 3U + corner]] != meshlet_id) ? 1U : 0U;
+        return count;
+    };
+    const auto close_meshlet = [&]() {
+        meshlets.push_back(components::meshlet {
+            .first_index = static_cast<uint32_t>((order.size() - meshlet_triangles) * 3U),
+            .index_count = static_cast<uint32_t>(meshlet_triangles * 3U)});
+        ++meshlet_id;
+        meshlet_triangles = 0U;
+        meshlet_vertices.clear();
+        center_sum = glm::vec3 {0.0f};
+    };
+
+    while(order.size() < triangle_count) {
+        // the neighbour adding the fewest vertices, ties are broken by the distance to the center
+        uint32_t best = NO_TRIANGLE;
+        uint32_t best_new = 3U;
+        float best_distance = std::numeric_limits<float>::max();
+        const glm::vec3 center =
+            meshlet_triangles ? center_sum / static_cast<float>(meshlet_triangles) : glm::vec3 {};
+        for(const uint32_t vtx: meshlet_vertices) {
+            for(uint32_t adj_i = adjacency_offsets[vtx]; adj_i < adjacency_offsets[vtx + 1U];
+                ++adj_i) {
+                const uint32_t tri = adjacency[adj_i];
+                if(emitted[tri])
+                    continue;
+                const uint32_t added = new_vertices(tri);
+                const glm::vec3 offset = triangle_centers[tri] - center;
+                const float distance = glm::dot(offset, offset);
+                if((added < best_new) || ((added == best_new) && (distance < best_distance))) {
+                    best = tri;
+                    best_new = added;
+                    best_distance = distance;
+                }
+            }
+        }
+
+        if((best != NO_TRIANGLE)
+           && ((meshlet_vertices.size() + best_new > max_vertices)
+               || (meshlet_triangles + 1U > max_triangles)))
+            best = NO_TRIANGLE;
+
+        if(best == NO_TRIANGLE) {
+            if(meshlet_triangles > 0U)
+                close_meshlet();
+            while(emitted[seed])
+                ++seed;
+            best = static_cast<uint32_t>(seed);
+        }
+
+        emitted[best] = 1U;
+        order.push_back(best);
+        ++meshlet_triangles;
+        center_sum += triangle_centers[best];
+        for(std::size_t corner = 0U; corner < 3U; ++corner) {
+            const uint32_t vtx = indices[best * 3U + corner];
+            if(vertex_meshlet[vtx] != meshlet_id) {
+                vertex_meshlet[vtx] = meshlet_id;
+                meshlet_vertices.push_back(vtx);
+            }
+        }
+    }
+    close_meshlet();
+
+    const std::vector<uint32_t> source(indices.begin(), indices.end());
+    for(std::size_t tri_i = 0U; tri_i < order.size(); ++tri_i) {
+        for(std::size_t corner = 0U; corner < 3U; ++corner)
+            indices[tri_i * 3U + corner] = source[order[tri_i] * 3U + corner];
+    }
+
+    for(components::meshlet& output: meshlets)
+        compute_bounds(indices.subspan(output.first_index, output.index_count), vertices, output);
+    return meshlets;
+}
+
+void meshlet_builder::compute_bounds(std::span<const uint32_t> indices,
+                                     std::span<const components::vertex> vertices,
+                                     components::meshlet& output) {
+    components::aabb bounds {};
+    for(const uint32_t index: indices)
+        bounds.extend(vertices[index].position.pos);
+    if(bounds.empty())
+        return;
+
+    output.center = bounds.center();
+    float radius_squared = 0.0f;
+    for(const uint32_t index: indices) {
+        const glm::vec3 offset = vertices[index].position.pos - output.center;
+        radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+    }
+    output.radius = std::sqrt(radius_squared);
+
+    std::vector<glm::vec3> normals;
+    normals.reserve(indices.size() / 3U);
+    glm::vec3 normal_sum {0.0f};
+    for(std::size_t tri = 0U; tri + 2U < indices.size(); tri += 3U) {
+        const glm::vec3& p0 = vertices[indices[tri]].position.pos;
+        const glm::vec3 normal = glm::cross(vertices[indices[tri + 1U]].position.pos - p0,
+                                            vertices[indices[tri + 2U]].position.pos - p0);
+        const float length = glm::length(normal);
+        if(length <= 0.0f)
+            continue;
+        normals.push_back(normal / length);
+        normal_sum += normals.back();
+    }
+
+    output.cone_axis = glm::vec3 {0.0f, 0.0f, 1.0f};
+    output.cone_cutoff = 1.0f;
+    const float sum_length = glm::length(normal_sum);
+    if(normals.empty() || (sum_length <= 0.0f))
+        return;
+
+    output.cone_axis = normal_sum / sum_length;
+    float min_cosine = 1.0f;
+    for(const glm::vec3& normal: normals)
+        min_cosine = std::min(min_cosine, glm::dot(normal, output.cone_axis));
+    // every triangle faces away from a viewer whose direction is within 90 degrees minus the half
+    // angle of the axis, i.e. whose cosine to the axis exceeds the half angle's sine
+    if(min_cosine >= MIN_CONE_COSINE)
+        output.cone_cutoff = std::sqrt(1.0f - min_cosine * min_cosine);
+}
+
+}
@@ -1,57 +1,534 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <system_error>
+
 #include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <glm/matrix.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <spdlog/spdlog.h>
 
+#include "arcticvox/common/hash.hpp"
+#include "arcticvox/common/thread_pool.hpp"
+#include "arcticvox/components/compact_vertex.hpp"
+#include "arcticvox/components/meshlet.hpp"
+#include "arcticvox/components/submesh.hpp"
 #include "arcticvox/io/filesystem.hpp"
+#include "arcticvox/io/mesh_cache.hpp"
+#include "arcticvox/io/mesh_optimiser.hpp"
+#include "arcticvox/io/mesh_simplifier.hpp"
+#include "arcticvox/io/meshlet_builder.hpp"
 #include "arcticvox/io/model_builder.hpp"
 
 namespace arcticvox::io {
-bool model_builder::load_model(const std::filesystem::path& path) {
-    std::filesystem::path working_path;
-    if(path.is_absolute())
-        working_path = path;
-    else
-        working_path = get_current_exe_path() / path;
 
+namespace {
+static_assert(sizeof(components::vertex) == 13U * sizeof(float),
+              "Vertex welding compares vertices bitwise, the vertex layout must not be padded");
+
+constexpr uint32_t UNMAPPED_VERTEX = ~0U;
+constexpr std::size_t CONVERSION_CHUNK_SIZE = 16384U;
+//! Triangle count of every simplified level relative to the full mesh
+constexpr std::array<float, components::submesh::MAX_LODS> LOD_TRIANGLE_RATIOS {0.5f, 0.25f, 0.1f};
+//! A level has to drop at least this share of the previous level's triangles to be kept
+constexpr float MIN_LOD_REDUCTION = 0.1f;
+
+components::vertex convert_vertex(const aiMesh* mesh, const std::size_t vtx_i) {
+    components::vertex vtx {};
+    if(mesh->HasPositions()) {
+        vtx.position.pos = glm::vec3 {
+            mesh->mVertices[vtx_i].x, mesh->mVertices[vtx_i].y, mesh->mVertices[vtx_i].z};
+    }
+
+    if(mesh->HasNormals()) {
+        vtx.normal =
+            glm::vec3 {mesh->mNormals[vtx_i].x, mesh->mNormals[vtx_i].y, mesh->mNormals[vtx_i].z};
+    }
+
+    if(mesh->HasVertexColors(0)) {
+        vtx.colour.col = glm::vec4 {mesh->mColors[0][vtx_i].r,
+                                    mesh->mColors[0][vtx_i].g,
+                                    mesh->mColors[0][vtx_i].b,
+                                    1.0};
+    }
+
+    if(mesh->HasTextureCoords(0U)) {
+        vtx.uv.uv = glm::vec3 {mesh->mTextureCoords[0][vtx_i].x,
+                               mesh->mTextureCoords[0][vtx_i].y,
+                               mesh->mTextureCoords[0][vtx_i].z};
+    }
+    return vtx;
+}
+
+/**
+ * @brief Import layout of a single aiMesh in the output arrays
+ */
+struct mesh_range {
+    std::size_t first_vertex = 0U;    //!< First converted vertex, later the first welded one
+    std::size_t first_index = 0U;     //!< First index of the mesh's triangles
+    std::size_t index_count = 0U;     //!< Number of indices of the mesh's triangles
+    std::size_t unique_count = 0U;    //!< Number of vertices left after welding
+    components::aabb bounds {};       //!< Bounds of the welded vertices
+
+    mesh_optimisation_report optimisation {};    //!< Statistics of the optional optimisation
+
+    std::vector<uint32_t> lod_indices {};    //!< Simplified levels, later appended to indices
+    //! Simplified levels, first_index relative to lod_indices until they are appended
+    std::array<components::submesh_lod, components::submesh::MAX_LODS> lods {};
+    uint32_t lod_count = 0U;                 //!< Number of valid entries in lods
+
+    std::vector<components::meshlet> meshlets {};    //!< Meshlets of the full mesh
+    uint32_t first_meshlet = 0U;                     //!< First meshlet in the builder's meshlets
+};
+
+/**
+ * @brief Calls fn for every index in [0, count), in parallel if a worker pool is available
+ */
+void for_each_index(thread_pool* workers,
+                    const std::size_t count,
+                    const std::function<void(std::size_t)>& fn) {
+    if(workers) {
+        workers->parallel_for(count, fn);
+        return;
+    }
+    for(std::size_t i = 0U; i < count; ++i)
+        fn(i);
+}
+
+/**
+ * @brief Calls fn with the source vertex index of every triangle corner of the mesh
+ *
+ * @details Points and lines are not rendered and skipped, polygons left over by the triangulation
+ * step are split into a fan.
+ */
+template<typename F>
+void for_each_triangle_corner(const aiMesh* mesh, F&& fn) {
+    for(std::size_t face_i = 0U; face_i < mesh->mNumFaces; ++face_i) {
+        const aiFace& face = mesh->mFaces[face_i];
+        for(uint32_t corner = 2U; corner < face.mNumIndices; ++corner) {
+            fn(face.mIndices[0]);
+            fn(face.mIndices[corner - 1U]);
+            fn(face.mIndices[corner]);
+        }
+    }
+}
+
+std::size_t count_triangle_indices(const aiMesh* mesh) {
+    std::size_t count = 0U;
+    for(std::size_t face_i = 0U; face_i < mesh->mNumFaces; ++face_i) {
+        if(mesh->mFaces[face_i].mNumIndices >= 3U)
+            count += (mesh->mFaces[face_i].mNumIndices - 2U) * 3U;
+    }
+    return count;
+}
+
+/**
+ * @brief Welds the converted vertices of one mesh in place and writes its triangle indices
+ *
+ * @param mesh The source mesh
+ * @param vertices The mesh's converted vertices, one per source vertex
+ * @param indices The mesh's index range, receives indices relative to vertices
+ * @param range The mesh's range, receives the unique vertex count and bounds
+ *
+ * @details Bitwise identical vertices are found with an open addressing hash table over the
+ * vertex bytes. Every referenced vertex that is the first of its kind is kept and the kept
+ * vertices are compacted to the front of the range in source order, so vertices only ever move
+ * towards lower addresses and no extra vertex storage is needed.
+ */
+void weld_mesh(const aiMesh* mesh,
+               components::vertex* vertices,
+               uint32_t* indices,
+               mesh_range& range) {
+    const std::size_t vertex_count = mesh->mNumVertices;
+
+    // the table holds at most vertex_count entries and thereby never exceeds a load factor of 0.5
+    std::vector<uint32_t> slots(std::bit_ceil(std::max<std::size_t>(vertex_count * 2U, 16U)),
+                                UNMAPPED_VERTEX);
+    const std::size_t mask = slots.size() - 1U;
+
+    // source index of the first vertex with the same contents, for every referenced vertex
+    std::vector<uint32_t> representative(vertex_count, UNMAPPED_VERTEX);
+    for_each_triangle_corner(mesh, [&](const uint32_t source_index) {
+        if(representative[source_index] != UNMAPPED_VERTEX)
+            return;
+        const components::vertex& vtx = vertices[source_index];
+        for(std::size_t slot = hash_bytes(&vtx, sizeof(vtx)) & mask;; slot = (slot + 1U) & mask) {
+            uint32_t& entry = slots[slot];
+            if(entry == UNMAPPED_VERTEX) {
+                entry = source_index;
+                representative[source_index] = source_index;
+                return;
+            }
+            if(std::memcmp(&vertices[entry], &vtx, sizeof(vtx)) == 0) {
+                representative[source_index] = entry;
+                return;
+            }
+        }
+    });
+
+    // reuse the table's storage for the welded index of every kept vertex
+    std::vector<uint32_t>& welded_index = slots;
+    uint32_t unique_count = 0U;
+    for(uint32_t source_index = 0U; source_index < vertex_count; ++source_index) {
+        if(representative[source_index] != source_index)
+            continue;
+        if(unique_count != source_index)
+            vertices[unique_count] = vertices[source_index];
+        range.bounds.extend(vertices[unique_count].position.pos);
+        welded_index[source_index] = unique_count++;
+    }
+
+    std::size_t index_i = 0U;
+    for_each_triangle_corner(mesh, [&](const uint32_t source_index) {
+        indices[index_i++] = welded_index[representative[source_index]];
+    });
+    range.unique_count = unique_count;
+}
+
+/**
+ * @brief Partitions one welded mesh into meshlets, stored in range.meshlets
+ *
+ * @param vertices The mesh's welded vertices
+ * @param indices The mesh's full triangle list, reordered into meshlet order
+ * @param range The mesh's range, receives the meshlets with absolute index ranges
+ * @param optimise Reorder the triangles within every meshlet for the vertex cache
+ */
+void build_meshlets(std::span<const components::vertex> vertices,
+                    std::span<uint32_t> indices,
+                    mesh_range& range,
+                    const bool optimise) {
+    range.meshlets = meshlet_builder::build(indices, vertices);
+    for(components::meshlet& cluster: range.meshlets) {
+        if(optimise)
+            mesh_optimiser::optimise_vertex_cache(
+                indices.subspan(cluster.first_index, cluster.index_count), vertices.size());
+        cluster.first_index += static_cast<uint32_t>(range.first_index);
+    }
+}
+
+/**
+ * @brief Builds the simplified levels of one welded mesh into range.lod_indices
+ *
+ * @param vertices The mesh's welded vertices
+ * @param indices The mesh's full triangle list, relative to vertices
+ * @param range The mesh's range, receives the levels
+ * @param optimise Reorder the levels' triangles for the vertex cache as well
+ *
+ * @details Every level is simplified from the full mesh, so its error is measured against the
+ * original surface rather than accumulated over the chain.
+ */
+void generate_lods(std::span<const components::vertex> vertices,
+                   std::span<const uint32_t> indices,
+                   mesh_range& range,
+                   const bool optimise) {
+    std::vector<uint32_t> simplified(indices.size());
+    std::size_t previous_count = indices.size();
+    for(const float ratio: LOD_TRIANGLE_RATIOS) {
+        const std::size_t target_count =
+            static_cast<std::size_t>(static_cast<float>(indices.size() / 3U) * ratio) * 3U;
+        if(target_count < 3U)
+            break;
+
+        const simplification_result result =
+            mesh_simplifier::simplify(simplified, indices, vertices, target_count);
+        if(static_cast<float>(result.index_count)
+           > static_cast<float>(previous_count) * (1.0f - MIN_LOD_REDUCTION))
+            break;
+
+        const std::span<uint32_t> lod {simplified.data(), result.index_count};
+        if(optimise)
+            mesh_optimiser::optimise_vertex_cache(lod, vertices.size());
+
+        range.lods[range.lod_count++] =
+            components::submesh_lod {.first_index = static_cast<uint32_t>(range.lod_indices.size()),
+                                     .index_count = static_cast<uint32_t>(result.index_count),
+                                     .error = result.error};
+        range.lod_indices.insert(range.lod_indices.end(), lod.begin(), lod.end());
+        previous_count = result.index_count;
+    }
+}
+
+/**
+ * @brief Converts a row major assimp matrix into a column major glm one
+ */
+glm::mat4 convert_matrix(const aiMatrix4x4& m) {
+    return glm::mat4 {glm::vec4 {m.a1, m.b1, m.c1, m.d1},
+                      glm::vec4 {m.a2, m.b2, m.c2, m.d2},
+                      glm::vec4 {m.a3, m.b3, m.c3, m.d3},
+                      glm::vec4 {m.a4, m.b4, m.c4, m.d4}};
+}
+
+components::submesh make_submesh(const aiMesh* mesh,
+                                 const mesh_range& range,
+                                 const glm::mat4& transform) {
+    return components::submesh {.first_index = static_cast<uint32_t>(range.first_index),
+                                .index_count = static_cast<uint32_t>(range.index_count),
+                                .vertex_offset = static_cast<int32_t>(range.first_vertex),
+                                .material_id = mesh->mMaterialIndex,
+                                .bounds = range.bounds,
+                                .transform = transform,
+                                .lod_count = range.lod_count,
+                                .first_meshlet = range.first_meshlet,
+                                .meshlet_count = static_cast<uint32_t>(range.meshlets.size()),
+                                .lods = range.lods};
+}
+
+/**
+ * @brief Walks the node hierarchy and emits a submesh for every mesh reference of every node
+ *
+ * @details Meshes without triangles are skipped, they have nothing to draw.
+ */
+void collect_submeshes(const aiScene* scene,
+                       const aiNode* node,
+                       const glm::mat4& parent_transform,
+                       const std::vector<mesh_range>& ranges,
+                       std::vector<components::submesh>& submeshes) {
+    const glm::mat4 transform = parent_transform * convert_matrix(node->mTransformation);
+    for(uint32_t mesh_ref = 0U; mesh_ref < node->mNumMeshes; ++mesh_ref) {
+        const uint32_t mesh_i = node->mMeshes[mesh_ref];
+        if(ranges[mesh_i].index_count > 0U)
+            submeshes.push_back(make_submesh(scene->mMeshes[mesh_i], ranges[mesh_i], transform));
+    }
+    for(uint32_t child = 0U; child < node->mNumChildren; ++child)
+        collect_submeshes(scene, node->mChildren[child], transform, ranges, submeshes);
+}
+
+bool import_model(const std::filesystem::path& path, model_builder& builder) {
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path.string(), 0U);
+    const aiScene* scene = importer.ReadFile(path.string(), aiProcess_Triangulate);
 
     if(!scene || !scene->HasMeshes()) {
         spdlog::warn("Scene {} has no meshes", path.string());
         return false;
     }
 
+    std::vector<mesh_range> ranges(scene->mNumMeshes);
+    for_each_index(builder.workers, scene->mNumMeshes, [&](const std::size_t mesh_i) {
+        ranges[mesh_i].index_count = count_triangle_indices(scene->mMeshes[mesh_i]);
+    });
+
+    // prefix sums over the per mesh sizes, so the output is allocated once and every mesh knows
+    // its final slots
+    std::size_t source_vertex_count = 0U;
+    std::size_t index_count = 0U;
     for(std::size_t mesh_i = 0U; mesh_i < scene->mNumMeshes; ++mesh_i) {
-        const aiMesh* mesh = scene->mMeshes[mesh_i];
-        for(std::size_t vtx_i = 0U; vtx_i < mesh->mNumVertices; ++vtx_i) {
-            components::vertex vtx {};
-            if(mesh->HasPositions()) {
-                vtx.position.pos = glm::vec3 {
-                    mesh->mVertices[vtx_i].x, mesh->mVertices[vtx_i].y, mesh->mVertices[vtx_i].z};
-            }
+        ranges[mesh_i].first_vertex = source_vertex_count;
+        ranges[mesh_i].first_index = index_count;
+        source_vertex_count += scene->mMeshes[mesh_i]->mNumVertices;
+        index_count += ranges[mesh_i].index_count;
+    }
+    builder.vertices.resize(source_vertex_count);
+    builder.indices.resize(index_count);
 
-            if(mesh->HasNormals()) {
-                vtx.normal = glm::vec3 {
-                    mesh->mNormals[vtx_i].x, mesh->mNormals[vtx_i].y, mesh->mNormals[vtx_i].z};
-            }
+    // large meshes are split into chunks, so a single dense mesh doesn't serialise the conversion
+    struct conversion_chunk {
+        std::size_t mesh;
+        std::size_t first_vertex;
+        std::size_t vertex_count;
+    };
+    std::vector<conversion_chunk> chunks;
+    for(std::size_t mesh_i = 0U; mesh_i < scene->mNumMeshes; ++mesh_i) {
+        const std::size_t mesh_vertex_count = scene->mMeshes[mesh_i]->mNumVertices;
+        for(std::size_t first = 0U; first < mesh_vertex_count; first += CONVERSION_CHUNK_SIZE)
+            chunks.push_back(conversion_chunk {
+                mesh_i, first, std::min(CONVERSION_CHUNK_SIZE, mesh_vertex_count - first)});
+    }
 
-            if(mesh->HasVertexColors(0)) {
-                vtx.colour.col = glm::vec4 {mesh->mColors[0][vtx_i].r,
-                                            mesh->mColors[0][vtx_i].g,
-                                            mesh->mColors[0][vtx_i].b,
-                                            1.0};
-            }
+    for_each_index(builder.workers, chunks.size(), [&](const std::size_t chunk_i) {
+        const conversion_chunk& chunk = chunks[chunk_i];
+        const aiMesh* mesh = scene->mMeshes[chunk.mesh];
+        components::vertex* output = builder.vertices.data() + ranges[chunk.mesh].first_vertex;
+        for(std::size_t vtx_i = chunk.first_vertex; vtx_i < chunk.first_vertex + chunk.vertex_count;
+            ++vtx_i)
+            output[vtx_i] = convert_vertex(mesh, vtx_i);
+    });
 
-            if(mesh->HasTextureCoords(0U)) {
-                vtx.uv.uv = glm::vec3 {mesh->mTextureCoords[0][vtx_i].x,
-                                       mesh->mTextureCoords[0][vtx_i].y,
-                                       mesh->mTextureCoords[0][vtx_i].z};
-            }
-            vertices.push_back(vtx);
+    // vertices are welded per mesh only, so every mesh keeps a contiguous vertex range
+    for_each_index(builder.workers, scene->mNumMeshes, [&](const std::size_t mesh_i) {
+        mesh_range& range = ranges[mesh_i];
+        weld_mesh(scene->mMeshes[mesh_i],
+                  builder.vertices.data() + range.first_vertex,
+                  builder.indices.data() + range.first_index,
+                  range);
+        // indices are still local to the mesh here, which is what the optimiser works on
+        if(builder.optimise_meshes)
+            range.optimisation = mesh_optimiser::optimise(
+                std::span {builder.vertices.data() + range.first_vertex, range.unique_count},
+                std::span {builder.indices.data() + range.first_index, range.index_count});
+        if(builder.build_meshlets)
+            build_meshlets(
+                std::span {builder.vertices.data() + range.first_vertex, range.unique_count},
+                std::span {builder.indices.data() + range.first_index, range.index_count},
+                range,
+                builder.optimise_meshes);
+        if(builder.generate_lods)
+            generate_lods(
+                std::span {builder.vertices.data() + range.first_vertex, range.unique_count},
+                std::span {builder.indices.data() + range.first_index, range.index_count},
+                range,
+                builder.optimise_meshes);
+    });
+
+    // close the gaps left by welding, in mesh order every range only moves towards lower addresses
+    std::size_t vertex_count = 0U;
+    for(mesh_range& range: ranges) {
+        if(range.first_vertex != vertex_count)
+            std::memmove(builder.vertices.data() + vertex_count,
+                         builder.vertices.data() + range.first_vertex,
+                         range.unique_count * sizeof(components::vertex));
+        range.first_vertex = vertex_count;
+        vertex_count += range.unique_count;
+        builder.bounds.extend(range.bounds);
+    }
+    builder.vertices.resize(vertex_count);
+
+    for(mesh_range& range: ranges) {
+        range.first_meshlet = static_cast<uint32_t>(builder.meshlets.size());
+        builder.meshlets.insert(
+            builder.meshlets.end(), range.meshlets.cbegin(), range.meshlets.cend());
+    }
+
+    // the simplified levels follow all full meshes, so the full ranges stay contiguous
+    std::size_t lod_index_count = 0U;
+    for(mesh_range& range: ranges) {
+        for(uint32_t level = 0U; level < range.lod_count; ++level)
+            range.lods[level].first_index += static_cast<uint32_t>(builder.indices.size());
+        builder.indices.insert(
+            builder.indices.end(), range.lod_indices.cbegin(), range.lod_indices.cend());
+        lod_index_count += range.lod_indices.size();
+        range.lod_indices = {};
+    }
+
+    // indices stay relative to their mesh, the draws pass the mesh's first vertex as offset
+    if(scene->mRootNode) {
+        collect_submeshes(scene, scene->mRootNode, glm::mat4 {1.0f}, ranges, builder.submeshes);
+    } else {
+        for(std::size_t mesh_i = 0U; mesh_i < scene->mNumMeshes; ++mesh_i) {
+            if(ranges[mesh_i].index_count > 0U)
+                builder.submeshes.push_back(
+                    make_submesh(scene->mMeshes[mesh_i], ranges[mesh_i], glm::mat4 {1.0f}));
         }
     }
 
+    spdlog::info("Welded {} source vertices into {} unique vertices and {} indices, {} submeshes",
+                 source_vertex_count,
+                 builder.vertices.size(),
+                 index_count,
+                 builder.submeshes.size());
+    if(builder.build_meshlets)
+        spdlog::info("Partitioned meshes into {} meshlets", builder.meshlets.size());
+    if(builder.generate_lods)
+        spdlog::info("Generated {} level of detail indices", lod_index_count);
+
+    if(builder.optimise_meshes) {
+        mesh_optimisation_report report {};
+        for(const mesh_range& range: ranges)
+            report += range.optimisation;
+        spdlog::info("Optimised meshes: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, overdraw "
+                     "{:.3f} -> {:.3f}",
+                     report.cache_before.acmr(),
+                     report.cache_after.acmr(),
+                     report.cache_before.atvr(),
+                     report.cache_after.atvr(),
+                     report.overdraw_before.overdraw(),
+                     report.overdraw_after.overdraw());
+    }
+    return true;
+}
+}
+
+bool model_builder::load_model(const std::filesystem::path& path) {
+    std::filesystem::path working_path;
+    if(path.is_absolute())
+        working_path = path;
+    else
+        working_path = get_current_exe_path() / path;
+
+    const auto start = std::chrono::steady_clock::now();
+    compact_vertices.clear();
+
+    const uint32_t cache_flags = (optimise_meshes ? mesh_cache::FLAG_OPTIMISED : 0U)
+                                 | (generate_lods ? mesh_cache::FLAG_LODS : 0U)
+                                 | (build_meshlets ? mesh_cache::FLAG_MESHLETS : 0U);
+    std::optional<uint64_t> source_hash;
+    uint64_t source_size = 0U;
+    if(use_mesh_cache) {
+        std::error_code error;
+        source_size = std::filesystem::file_size(working_path, error);
+        if(!error)
+            source_hash = mesh_cache::hash_file(working_path);
+        if(source_hash
+           && mesh_cache::load(mesh_cache::cache_path(*source_hash, cache_flags),
+                               *source_hash,
+                               source_size,
+                               cache_flags,
+                               *this)) {
+            spdlog::info("Loaded {} from mesh cache in {} ms",
+                         working_path.string(),
+                         std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count());
+            if(vertex_format == components::vertex_format::compact)
+                quantise_vertices();
+            return true;
+        }
+    }
+
+    vertices.clear();
+    indices.clear();
+    submeshes.clear();
+    meshlets.clear();
+    bounds = components::aabb {};
+    if(!import_model(working_path, *this))
+        return false;
+
+    spdlog::info("Imported {} in {} ms",
+                 working_path.string(),
+                 std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count());
+
+    if(source_hash)
+        mesh_cache::store(mesh_cache::cache_path(*source_hash, cache_flags),
+                          *source_hash,
+                          source_size,
+                          cache_flags,
+                          *this);
+
+    // the cache holds the full vertices, quantising them is cheap compared to the import
+    if(vertex_format == components::vertex_format::compact)
+        quantise_vertices();
     return true;
 }
+
+void model_builder::quantise_vertices() {
+    compact_vertices.resize(vertices.size());
+    for_each_index(workers,
+                   (vertices.size() + CONVERSION_CHUNK_SIZE - 1U) / CONVERSION_CHUNK_SIZE,
+                   [&](const std::size_t chunk_i) {
+                       const std::size_t first = chunk_i * CONVERSION_CHUNK_SIZE;
+                       const std::size_t last =
+                           std::min(first + CONVERSION_CHUNK_SIZE, vertices.size());
+                       for(std::size_t vtx_i = first; vtx_i < last; ++vtx_i)
+                           compact_vertices[vtx_i] =
+                               components::compact_vertex::quantise(vertices[vtx_i], bounds);
+                   });
+
+    spdlog::info("Quantised {} vertices from {} to {} bytes",
+                 vertices.size(),
+                 vertices.size() * sizeof(components::vertex),
+                 compact_vertices.size() * sizeof(components::compact_vertex));
+    vertices.clear();
+    vertices.shrink_to_fit();
+}
 }
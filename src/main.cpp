@@ -1,4 +1,6 @@
 #include <csignal>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #include <spdlog/spdlog.h>
@@ -7,32 +9,80 @@
 #include "arcticvox/components/fps_camera_controller.hpp"
 #include "arcticvox/components/gameobject.hpp"
 #include "arcticvox/components/model.hpp"
+#include "arcticvox/components/transform.hpp"
+#include "arcticvox/components/transform_store.hpp"
 #include "arcticvox/graphics/camera.hpp"
 #include "arcticvox/graphics/engine.hpp"
+#include "arcticvox/graphics/model_streamer.hpp"
+#include "arcticvox/graphics/render_system.hpp"
 #include "arcticvox/graphics/window.hpp"
 
 std::vector<arcticvox::components::gameobject> load_gameobjects(
-    arcticvox::graphics::gpu_driver& driver) {
+    arcticvox::graphics::model_streamer& streamer,
+    arcticvox::components::transform_store& transforms) {
     std::vector<arcticvox::components::gameobject> objs {};
 
-    arcticvox::io::model_builder builder {};
-    if(!builder.load_model("/home/fubutea/repos/HoloVox/resources/models/2b_kimono/source/28.glb"))
-        throw std::runtime_error("Unable to open model file");
-
-    auto model = std::make_shared<arcticvox::components::model>(driver, builder);
-
-    auto gameobj = arcticvox::components::gameobject::make_gameobject();
-    gameobj.model = model;
-    gameobj.transform.rotation =
-        glm::angleAxis(-glm::half_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f))
-        * glm::angleAxis(-glm::half_pi<float>(), glm::vec3(0.0f, 0.0, 1.0f));
-    gameobj.transform.translation = {0.0f, 0.0f, 2.5f};
-    gameobj.transform.scale = {2., 2.f, 2.f};
+    // the cube is drawn until the model has been imported and uploaded in the background
+    auto gameobj = arcticvox::components::gameobject::make_gameobject(
+        transforms,
+        arcticvox::components::transform {
+            .rotation = glm::angleAxis(-glm::half_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f))
+                        * glm::angleAxis(-glm::half_pi<float>(), glm::vec3(0.0f, 0.0, 1.0f)),
+            .scale = {2.0f, 2.0f, 2.0f},
+            .translation = {0.0f, 0.0f, 2.5f}});
+    gameobj.model = streamer.placeholder();
+    gameobj.pending_model =
+        streamer.load("/home/fubutea/repos/HoloVox/resources/models/2b_kimono/source/28.glb",
+                      arcticvox::io::model_builder {
+                          .optimise_meshes = true,
+                          .generate_lods = true,
+                          .build_meshlets = true,
+                          .vertex_format = arcticvox::components::vertex_format::compact});
     objs.push_back(std::move(gameobj));
 
     return objs;
 }
 
+/**
+ * @brief Reads the submission from the arguments, given as --submission followed by its name
+ *
+ * @details Empty if none is given, the render system then keeps its default, indirect submission
+ * where supported. GPU culled submission draws every submesh at full detail without meshlets and
+ * keeps all models resident, so it is only used when asked for.
+ */
+std::optional<arcticvox::graphics::render_system::submission> select_submission(const int argc,
+                                                                               char** argv) {
+    using submission = arcticvox::graphics::render_system::submission;
+    std::optional<submission> mode {};
+    for(int arg = 1; arg + 1 < argc; ++arg) {
+        if(std::string_view {argv[arg]} != "--submission")
+            continue;
+        const std::string_view name {argv[arg + 1]};
+        if(name == "direct")
+            mode = submission::direct;
+        else if(name == "indirect")
+            mode = submission::indirect;
+        else if(name == "parallel")
+            mode = submission::parallel;
+        else if(name == "gpu_culled")
+            mode = submission::gpu_culled;
+        else
+            spdlog::warn("Unknown submission {}, keeping the default", name);
+    }
+    return mode;
+}
+
+/**
+ * @brief Returns whether the flag is among the arguments
+ */
+bool has_flag(const int argc, char** argv, const std::string_view flag) {
+    for(int arg = 1; arg < argc; ++arg) {
+        if(std::string_view {argv[arg]} == flag)
+            return true;
+    }
+    return false;
+}
+
 auto main(int argc, char** argv) -> int {
     engine_configuration config {.app_name = "holovox",
                                  .app_version = 0U,
@@ -45,11 +95,20 @@ auto main(int argc, char** argv) -> int {
         arcticvox::graphics::camera camera {};
         arcticvox::components::fps_camera_controller cam_controller {avox_engine.get_window()};
         std::vector<arcticvox::components::gameobject> render_objects =
-            load_gameobjects(avox_engine.get_gpu_driver());
+            load_gameobjects(avox_engine.get_model_streamer(), avox_engine.get_transforms());
         camera.set_view_direction(glm::vec3(0.0f), glm::vec3(0.f, 0.0f, 1.f));
         camera.set_camera_controller(cam_controller);
         avox_engine.set_camera(camera);
         avox_engine.set_objects_to_render(render_objects);
+        const std::optional<arcticvox::graphics::render_system::submission> mode =
+            select_submission(argc, argv);
+        if(mode)
+            avox_engine.set_submission(*mode);
+        // meshlets are only culled on the host, the model is closed so their back faces are hidden
+        avox_engine.set_cone_culling(mode
+                                     != arcticvox::graphics::render_system::submission::gpu_culled);
+        // occlusion culling builds a depth pyramid and draws a second pass, only when asked for
+        avox_engine.set_occlusion_culling(has_flag(argc, argv, "--occlusion-culling"));
         avox_engine.run();
     } catch(const std::exception& e) {
         spdlog::error(e.what());